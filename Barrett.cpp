@@ -0,0 +1,138 @@
+#include "Barrett.hpp"
+#include "LimbKernels.hpp"
+#include "Exponentiation.hpp"
+#include "MultiplyTuning.hpp"
+#include "exceptions.hpp"
+
+BarrettContext::BarrettContext(const BigHexInt& value) : modulus(value) {
+    if (modulus.isZero()) {
+        throw DivisionByZeroException();
+    }
+    modulus.isNegative = false;
+    k = modulus.length;
+    while (k > 1 && modulus.limbs[k - 1] == 0) {
+        k--;
+    }
+    modulus.resize(k);
+
+    // mu = floor(B^(2k) / n) is below B^(k+1) except when n is a power of B, hence k + 2 limbs
+    BigHexInt reciprocal("1");
+    reciprocal <<= 2 * k * LIMB_BITS;
+    reciprocal = reciprocal / modulus;
+    mu.assign(k + 2, 0);
+    std::copy(reciprocal.limbs, reciprocal.limbs + std::min(reciprocal.length, k + 2), mu.begin());
+    paddedModulus.assign(modulus.limbs, modulus.limbs + k);
+    paddedModulus.push_back(0);
+}
+
+const BigHexInt& BarrettContext::getModulus() const {
+    return modulus;
+}
+
+int BarrettContext::limbCount() const {
+    return k;
+}
+
+int BarrettContext::scratchLimbs() const {
+    int base = multiplyThresholds.karatsuba;
+    return 3 * (k + 1) + shortProductScratchLimbs(k + 1, base);
+}
+
+// HAC 14.42: the estimate q3 = floor(floor(x / B^(k-1)) * mu / B^(k+1)) is at most
+// two below the true quotient, so x - q3 * n needs at most two corrections. Both
+// products are short: q3 is the high half of (k+1) x (k+1) limbs (mu's top limb is
+// only set when mu = B^(k+1)) and may come out a few units lower, which costs as many
+// extra corrections, and q3 * n is only needed modulo B^(k+1).
+void BarrettContext::reduceWide(const Limb* x, Limb* out, Limb* scratch) const {
+    int base = multiplyThresholds.karatsuba;
+    Limb* q3 = scratch;                 // k + 1 limbs
+    Limb* r2 = q3 + k + 1;              // k + 1 limbs
+    Limb* r = r2 + k + 1;               // k + 1 limbs
+    Limb* work = r + k + 1;
+    const Limb* n = modulus.limbs;
+
+    mulHighLimbs(q3, x + k - 1, mu.data(), k + 1, base, work);
+    if (mu[k + 1] != 0) {
+        addLimbs(q3, q3, k + 1, x + k - 1, k + 1);
+    }
+    mulLowLimbs(r2, q3, paddedModulus.data(), k + 1, base, work);
+
+    // r = x mod B^(k+1) - r2, wrapping modulo B^(k+1)
+    Limb borrow = 0;
+    for (int i = 0; i <= k; i++) {
+        Limb diff = x[i] - r2[i];
+        Limb newBorrow = (x[i] < r2[i]);
+        newBorrow += (diff < borrow);
+        r[i] = diff - borrow;
+        borrow = newBorrow;
+    }
+
+    while (compareLimbs(r, k + 1, n, k) >= 0) {
+        subLimbs(r, r, k + 1, n, k);
+    }
+    std::copy(r, r + k, out);
+}
+
+BigHexInt BarrettContext::store(const Limb* value) const {
+    BigHexInt result;
+    result.resize(k);
+    std::copy(value, value + k, result.limbs);
+    result.trim();
+    return result;
+}
+
+// Folds the magnitude in from the top, one k-limb chunk at a time: each step reduces
+// r * B^k + chunk, which stays below n * B^k
+BigHexInt BarrettContext::reduceMagnitude(const BigHexInt& value) const {
+    int len = value.length;
+    while (len > 1 && value.limbs[len - 1] == 0) {
+        len--;
+    }
+    std::vector<Limb> buffer(2 * k, 0), scratch(scratchLimbs());
+    int chunks = (len + k - 1) / k;
+    for (int c = chunks - 1; c >= 0; c--) {
+        std::copy(buffer.begin(), buffer.begin() + k, buffer.begin() + k);
+        std::fill(buffer.begin(), buffer.begin() + k, 0);
+        int begin = c * k;
+        int end = std::min(begin + k, len);
+        std::copy(value.limbs + begin, value.limbs + end, buffer.begin());
+        reduceWide(buffer.data(), buffer.data(), scratch.data());
+    }
+    return store(buffer.data());
+}
+
+BigHexInt BarrettContext::reduce(const BigHexInt& value) const {
+    BigHexInt result = reduceMagnitude(value);
+    if (value.isNegative && !result.isZero()) {
+        BigHexInt complement = modulus;
+        complement -= result;
+        return complement;
+    }
+    return result;
+}
+
+BigHexInt BarrettContext::multiply(const BigHexInt& a, const BigHexInt& b) const {
+    return reduce(reduce(a) * reduce(b));
+}
+
+BigHexInt BarrettContext::modPow(const BigHexInt& base, const BigHexInt& exponent) const {
+    if (exponent.isNegative) {
+        throw std::invalid_argument("Negative exponents not supported in modular exponentiation");
+    }
+
+    BigHexInt reduced = reduce(base);
+    std::vector<Limb> x(k, 0), unit(k, 0), product(2 * k), scratch(scratchLimbs());
+    std::copy(reduced.limbs, reduced.limbs + std::min(reduced.length, k), x.begin());
+    unit[0] = modulus.isOne() ? 0 : 1;
+
+    std::vector<Limb> result = windowedPow(x, unit, exponent,
+        [this, &product, &scratch](std::vector<Limb>& out, const std::vector<Limb>& a, const std::vector<Limb>& b) {
+            if (&a == &b) {
+                sqrLimbs(product.data(), a.data(), k);
+            } else {
+                mulLimbs(product.data(), a.data(), k, b.data(), k);
+            }
+            reduceWide(product.data(), out.data(), scratch.data());
+        });
+    return store(result.data());
+}
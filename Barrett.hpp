@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+#include <vector>
+
+// Precomputed reciprocal mu = floor(B^(2k) / n) for one modulus n of k limbs
+// (B = 2^64). A double-width value is reduced with two multiplications and at
+// most two subtractions, so unlike Montgomery form it works for even moduli and
+// needs no conversion in or out.
+class BarrettContext {
+public:
+    // Throws DivisionByZeroException for a zero modulus; the sign is ignored
+    explicit BarrettContext(const BigHexInt& modulus);
+
+    const BigHexInt& getModulus() const;
+    int limbCount() const;
+
+    // value mod n as the least non-negative residue, for values of any size and sign
+    BigHexInt reduce(const BigHexInt& value) const;
+    // a * b mod n
+    BigHexInt multiply(const BigHexInt& a, const BigHexInt& b) const;
+    // base^exponent mod n; exponent must not be negative
+    BigHexInt modPow(const BigHexInt& base, const BigHexInt& exponent) const;
+
+private:
+    BigHexInt modulus;
+    int k;
+    std::vector<Limb> mu;   // k + 2 limbs
+    std::vector<Limb> paddedModulus;   // k + 1 limbs, the operand of the short product q3 * n
+
+    // out[0 .. k) = x mod n for x[0 .. 2k) < n * B^k; scratch holds scratchLimbs() limbs
+    void reduceWide(const Limb* x, Limb* out, Limb* scratch) const;
+    int scratchLimbs() const;
+    BigHexInt reduceMagnitude(const BigHexInt& value) const;
+    BigHexInt store(const Limb* value) const;
+};
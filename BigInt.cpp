@@ -1,26 +1,109 @@
 #include "Bigint.hpp"
 #include "exceptions.hpp"
 #include "Timer.hpp"
+#include "KaratsubaCache.hpp"
+#include "MemoStore.hpp"
+#include "Montgomery.hpp"
+#include "LimbKernels.hpp"
+#include "Barrett.hpp"
+#include "Exponentiation.hpp"
+#include "Ntt.hpp"
+#include "MultiplyTuning.hpp"
+#include "ThreadPool.hpp"
 
 //constructors
-BigInt::BigInt() : length(0), isNegative(false) {
-        std::fill(digits, digits + MAX_DIGITS, 0);
+BigInt::BigInt() : length(1), isNegative(false) {
+        std::fill(limbs, limbs + MAX_DECIMAL_LIMBS, 0);
 }
 
 BigInt::BigInt(const std::string& str) {
         *this = createFromString(str);
 }
 
-BigHexInt::BigHexInt() : length(1), isNegative(false) {
-        std::fill(digits, digits + MAX_HEX_RESULT_SIZE, '0');
+BigHexInt::BigHexInt() : limbs(inlineLimbs), length(1), capacity(INLINE_LIMBS), isNegative(false) {
+        limbs[0] = 0;
 }
 
-BigHexInt::BigHexInt(const std::string& str) {
+BigHexInt::BigHexInt(const std::string& str) : BigHexInt() {
         *this = createFromString(str);
 }
 
+BigHexInt::BigHexInt(const BigHexInt& other) : BigHexInt() {
+        *this = other;
+}
+
+BigHexInt::BigHexInt(BigHexInt&& other) noexcept : BigHexInt() {
+        *this = std::move(other);
+}
+
+BigHexInt& BigHexInt::operator=(const BigHexInt& other) {
+        if (this == &other) {
+                return *this;
+        }
+        length = 1;
+        reserve(other.length);
+        std::copy(other.limbs, other.limbs + other.length, limbs);
+        length = other.length;
+        isNegative = other.isNegative;
+        return *this;
+}
+
+BigHexInt& BigHexInt::operator=(BigHexInt&& other) noexcept {
+        if (this == &other) {
+                return *this;
+        }
+        if (other.limbs != other.inlineLimbs) {
+                // Steal the heap buffer and leave the source as an inline zero
+                if (limbs != inlineLimbs) {
+                        delete[] limbs;
+                }
+                limbs = other.limbs;
+                capacity = other.capacity;
+                other.limbs = other.inlineLimbs;
+                other.capacity = INLINE_LIMBS;
+                other.limbs[0] = 0;
+        } else {
+                // Small values are copied; keep any heap buffer we already own
+                std::copy(other.limbs, other.limbs + other.length, limbs);
+        }
+        length = other.length;
+        isNegative = other.isNegative;
+        other.length = 1;
+        other.isNegative = false;
+        return *this;
+}
+
+BigHexInt::~BigHexInt() {
+        if (limbs != inlineLimbs) {
+                delete[] limbs;
+        }
+}
+
+// Grows storage to hold at least n limbs, preserving the limbs in use
+void BigHexInt::reserve(int n) {
+        if (n <= capacity) {
+                return;
+        }
+        int newCapacity = std::max(n, capacity * 2);
+        Limb* grown = new Limb[newCapacity];
+        std::copy(limbs, limbs + length, grown);
+        if (limbs != inlineLimbs) {
+                delete[] limbs;
+        }
+        limbs = grown;
+        capacity = newCapacity;
+}
+
+// Sets the number of limbs in use, zero-filling any newly exposed limbs
+void BigHexInt::resize(int n) {
+        reserve(n);
+        if (n > length) {
+                std::fill(limbs + length, limbs + n, 0);
+        }
+        length = n;
+}
+
 // Global variable definitions
-std::map<std::pair<std::string, std::string>, std::string> karatsubaMemo;
 int hexMultiplyLookup[HEX_LOOKUP_SIZE][HEX_LOOKUP_SIZE];
 
 
@@ -34,7 +117,6 @@ BigInt BigInt::createFromString(const std::string& str) {
     
     BigInt result;
     result.isNegative = false;
-    result.length = 0;
 
     int start = 0;
     if (str[0] == '-') {
@@ -42,19 +124,24 @@ BigInt BigInt::createFromString(const std::string& str) {
         start = 1;
     }
 
-    result.length = str.length() - start;
+    int digitCount = str.length() - start;
     
-    if (result.length > MAX_DIGITS) {
+    if (digitCount > MAX_DIGITS) {
         throw OverflowException("BigInt creation");
     }
 
-    for (int i = 0; i < result.length; i++) {
-        result.digits[i] = str[result.length - 1 - i + start] - '0';
-    }
-
-    for (int i = result.length; i < MAX_DIGITS; i++) {
-        result.digits[i] = 0;
+    // Convert 9 characters at a time, starting from the least significant end
+    int limbCount = 0;
+    for (int end = str.length(); end > start; end -= DECIMAL_DIGITS_PER_LIMB) {
+        int begin = std::max(start, end - DECIMAL_DIGITS_PER_LIMB);
+        uint32_t value = 0;
+        for (int i = begin; i < end; i++) {
+            value = value * 10 + (str[i] - '0');
+        }
+        result.limbs[limbCount++] = value;
     }
+    result.length = limbCount;
+    result.trim();
 
     return result;
 }
@@ -63,118 +150,134 @@ void BigInt::print() const {
     if (isNegative) {
         std::cout << "-";
     }
-    for (int i = length - 1; i >= 0; i--) {
-        std::cout << static_cast<int>(digits[i]);
+    // Top limb without leading zeros, every lower limb zero-padded to 9 digits
+    char buffer[DECIMAL_DIGITS_PER_LIMB + 1];
+    std::snprintf(buffer, sizeof(buffer), "%u", limbs[length - 1]);
+    std::cout << buffer;
+    for (int i = length - 2; i >= 0; i--) {
+        std::snprintf(buffer, sizeof(buffer), "%09u", limbs[i]);
+        std::cout << buffer;
     }
     std::cout << std::endl;
 }
 
+// Drops leading zero limbs and clears the sign of zero
+void BigInt::trim() {
+    while (length > 1 && limbs[length - 1] == 0) {
+        length--;
+    }
+    if (length == 1 && limbs[0] == 0) {
+        isNegative = false;
+    }
+}
+
 int BigInt::compare(const BigInt& other) const {
     if (length != other.length) {
         return (length > other.length) ? 1 : -1;
     }
 
     for (int i = length - 1; i >= 0; i--) {
-        if (digits[i] != other.digits[i]) {
-            return (digits[i] > other.digits[i]) ? 1 : -1;
+        if (limbs[i] != other.limbs[i]) {
+            return (limbs[i] > other.limbs[i]) ? 1 : -1;
         }
     }
     return 0;
 }
 
-BigInt BigInt::operator+(const BigInt& other) const {
-    if (isNegative == other.isNegative) {
-        BigInt result;
-        int carry = 0;
-        result.length = std::max(length, other.length);
-        result.isNegative = isNegative;
-        
-        if (result.length >= MAX_DIGITS - 1) {
-            throw OverflowException("addition");
+// Adds +|other| (or -|other| when otherNegative is set) to *this in place.
+// other may alias *this.
+void BigInt::accumulate(const BigInt& other, bool otherNegative) {
+    int otherLength = other.length;
+    if (isNegative == otherNegative) {
+        uint32_t carry = 0;
+        int newLength = std::max(length, otherLength);
+        for (int i = 0; i < newLength; i++) {
+            uint32_t sum = (i < length ? limbs[i] : 0) +
+                           (i < otherLength ? other.limbs[i] : 0) + carry;
+            carry = (sum >= DECIMAL_LIMB_BASE);
+            limbs[i] = carry ? sum - DECIMAL_LIMB_BASE : sum;
         }
-
-        for (int i = 0; i < result.length || carry; i++) {
-            int sum = (i < length ? digits[i] : 0) +
-                      (i < other.length ? other.digits[i] : 0) + carry;
-            result.digits[i] = sum % 10;
-            carry = sum / 10;
-            if (i == result.length) {                  //<-changed the >= to == need to check if it works 
-                result.length++;
+        length = newLength;
+        if (carry) {
+            if (length >= MAX_DECIMAL_LIMBS) {
+                throw OverflowException("addition");
             }
+            limbs[length++] = carry;
         }
-        return result;
     } else {
-        if (isNegative) {
-            BigInt absA = *this;
-            absA.isNegative = false;
-            return other - absA;
-        } else {
-            BigInt absB = other;
-            absB.isNegative = false;
-            return *this - absB;
+        // Subtract the smaller magnitude from the larger one
+        bool thisLarger = compare(other) >= 0;
+        const uint32_t* larger = thisLarger ? limbs : other.limbs;
+        const uint32_t* smaller = thisLarger ? other.limbs : limbs;
+        int largerLength = thisLarger ? length : otherLength;
+        int smallerLength = thisLarger ? otherLength : length;
+        uint32_t borrow = 0;
+        for (int i = 0; i < largerLength; i++) {
+            uint32_t subtrahend = (i < smallerLength ? smaller[i] : 0) + borrow;
+            if (larger[i] < subtrahend) {
+                limbs[i] = larger[i] + DECIMAL_LIMB_BASE - subtrahend;
+                borrow = 1;
+            } else {
+                limbs[i] = larger[i] - subtrahend;
+                borrow = 0;
+            }
+        }
+        length = largerLength;
+        if (!thisLarger) {
+            isNegative = otherNegative;
         }
     }
+    trim();
 }
 
-BigInt BigInt::operator-(const BigInt& other) const {
-    if (isNegative != other.isNegative) {
-        BigInt absB = other;
-        absB.isNegative = !other.isNegative;
-        return *this + absB;
-    }
-
-    BigInt result;
-    int borrow = 0;
-
-    if (compare(other) < 0) {
-        result = other - *this;
-        result.isNegative = !isNegative;
-        return result;
-    }
+BigInt& BigInt::operator+=(const BigInt& other) {
+    accumulate(other, other.isNegative);
+    return *this;
+}
 
-    result.length = length;
-    result.isNegative = isNegative;
+BigInt& BigInt::operator-=(const BigInt& other) {
+    accumulate(other, !other.isNegative);
+    return *this;
+}
 
-    for (int i = 0; i < result.length; i++) {
-        int diff = digits[i] - (i < other.length ? other.digits[i] : 0) - borrow;
-        if (diff < 0) {
-            diff += 10;
-            borrow = 1;
-        } else {
-            borrow = 0;
-        }
-        result.digits[i] = diff;
-    }
+BigInt& BigInt::operator*=(const BigInt& other) {
+    *this = *this * other;
+    return *this;
+}
 
-    while (result.length > 1 && result.digits[result.length - 1] == 0) {
-        result.length--;
-    }
+BigInt BigInt::operator+(const BigInt& other) const {
+    BigInt result(*this);
+    result += other;
+    return result;
+}
 
+BigInt BigInt::operator-(const BigInt& other) const {
+    BigInt result(*this);
+    result -= other;
     return result;
 }
 
 BigInt BigInt::operator*(const BigInt& other) const {
     BigInt result;
-    std::fill(result.digits, result.digits + MAX_DIGITS, 0);
     result.length = length + other.length;
     result.isNegative = isNegative != other.isNegative;
     
-    if (result.length >= MAX_DIGITS) {
+    if (result.length > MAX_DECIMAL_LIMBS) {
         throw OverflowException("multiplication");
     }
 
+    // Each partial product fits in 64 bits: (10^9)^2 + 2 * 10^9 < 2^64
     for (int i = 0; i < length; i++) {
-        int carry = 0;
-        for (int j = 0; j < other.length || carry; j++) {
-            int prod = result.digits[i + j] + digits[i] * (j < other.length ? other.digits[j] : 0) + carry;
-            result.digits[i + j] = prod % 10;
-            carry = prod / 10;
+        uint64_t carry = 0;
+        for (int j = 0; j < other.length; j++) {
+            uint64_t cur = result.limbs[i + j] + (uint64_t)limbs[i] * other.limbs[j] + carry;
+            result.limbs[i + j] = (uint32_t)(cur % DECIMAL_LIMB_BASE);
+            carry = cur / DECIMAL_LIMB_BASE;
         }
+        result.limbs[i + other.length] = (uint32_t)carry;
     }
 
-    while (result.length > 1 && result.digits[result.length - 1] == 0) {
-        result.length--;
-    }
+    result.trim();
     return result;
 }
 
@@ -211,7 +314,6 @@ BigHexInt BigHexInt::createFromString(const std::string& str) {
     
     BigHexInt result;
     result.isNegative = false;
-    std::fill(result.digits, result.digits + MAX_HEX_RESULT_SIZE, '0');
     
     int start = 0;
     if (str[0] == '-') {
@@ -220,19 +322,20 @@ BigHexInt BigHexInt::createFromString(const std::string& str) {
     }
     
     int inputLength = str.length() - start;
-    if (inputLength > HEX_SIZE) {
-        throw OverflowException("BigHexInt creation - exceeds " + std::to_string(HEX_SIZE) + " isHex digits");
-    }
-    
-    for (int i = 0; i < inputLength; i++) {
-        result.digits[i] = str[start + inputLength - 1 - i];
-    }
-    
-    int actualLength = HEX_SIZE;
-    while (actualLength > 1 && result.digits[actualLength-1] == '0') {
-        actualLength--;
+    result.reserve((inputLength + HEX_DIGITS_PER_LIMB - 1) / HEX_DIGITS_PER_LIMB);
+    
+    // Pack 16 hex characters per limb, starting from the least significant end
+    int limbCount = 0;
+    for (int end = str.length(); end > start; end -= HEX_DIGITS_PER_LIMB) {
+        int begin = std::max(start, end - HEX_DIGITS_PER_LIMB);
+        Limb value = 0;
+        for (int i = begin; i < end; i++) {
+            value = (value << 4) | (Limb)convertHexDigitToInt(str[i]);
+        }
+        result.limbs[limbCount++] = value;
     }
-    result.length = actualLength;
+    result.length = limbCount;
+    result.trim();
     
     return result;
 }
@@ -244,177 +347,341 @@ std::string BigHexInt::toString() const {
     }
     
     int msb = length - 1;
-    while (msb > 0 && digits[msb] == '0') {
+    while (msb > 0 && limbs[msb] == 0) {
         msb--;
     }
     
-    for (int i = msb; i >= 0; i--) {
-        result += digits[i];
+    // The top limb is printed without leading zeros, every lower limb is a full 16 characters
+    char buffer[HEX_DIGITS_PER_LIMB];
+    Limb top = limbs[msb];
+    int count = 0;
+    do {
+        buffer[count++] = HEX_DIGIT_STR[top & 0xf];
+        top >>= 4;
+    } while (top != 0);
+    while (count > 0) {
+        result += buffer[--count];
+    }
+    
+    for (int i = msb - 1; i >= 0; i--) {
+        Limb value = limbs[i];
+        for (int shift = LIMB_BITS - 4; shift >= 0; shift -= 4) {
+            result += HEX_DIGIT_STR[(value >> shift) & 0xf];
+        }
     }
     
     return result;
 }
 
 void BigHexInt::print() const {
-    if (isNegative) {
-        std::cout << "-";
-    }
-    
-    int msb = HEX_SIZE - 1;
-    while (msb > 0 && digits[msb] == '0') {
-        msb--;
+    std::cout << toString() << std::endl;
+}
+
+// Drops leading zero limbs and clears the sign of zero
+void BigHexInt::trim() {
+    while (length > 1 && limbs[length - 1] == 0) {
+        length--;
     }
-    
-    for (int i = msb; i >= 0; i--) {
-        std::cout << digits[i];
+    if (length == 1 && limbs[0] == 0) {
+        isNegative = false;
     }
-    std::cout << std::endl;
 }
 
 int BigHexInt::compare(const BigHexInt& other) const {
     if (isNegative && !other.isNegative) return -1;
     if (!isNegative && other.isNegative) return 1;
     
-    for (int i = HEX_SIZE - 1; i >= 0; i--) {
-        int digitA = convertHexDigitToInt(digits[i]);
-        int digitB = convertHexDigitToInt(other.digits[i]);
-        if (digitA != digitB) {
-            if (isNegative)
-                return (digitA > digitB) ? -1 : 1;
-            else
-                return (digitA > digitB) ? 1 : -1;
+    int cmp = compareLimbs(limbs, length, other.limbs, other.length);
+    return isNegative ? -cmp : cmp;
+}
+
+// Adds +|other| (or -|other| when otherNegative is set) to *this in place.
+// other may alias *this.
+void BigHexInt::accumulate(const BigHexInt& other, bool otherNegative) {
+    if (isNegative == otherNegative) {
+        int otherLength = other.length;
+        int newLength = std::max(length, otherLength);
+        reserve(newLength + 1);
+        Limb carry;
+        if (length >= otherLength) {
+            carry = addLimbs(limbs, limbs, length, other.limbs, otherLength);
+        } else {
+            carry = addLimbs(limbs, other.limbs, otherLength, limbs, length);
+        }
+        length = newLength;
+        if (carry != 0) {
+            limbs[length++] = carry;
         }
+    } else if (compareLimbs(limbs, length, other.limbs, other.length) >= 0) {
+        subLimbs(limbs, limbs, length, other.limbs, std::min(other.length, length));
+    } else {
+        int otherLength = other.length;
+        reserve(otherLength);
+        subLimbs(limbs, other.limbs, otherLength, limbs, std::min(length, otherLength));
+        length = otherLength;
+        isNegative = otherNegative;
     }
-    return 0;
+    trim();
 }
 
-BigHexInt BigHexInt::operator+(const BigHexInt& other) const {
-    if (isNegative != other.isNegative) {
-        if (isNegative) {
-            BigHexInt absA = *this;
-            absA.isNegative = false;
-            return other - absA;
-        } else {
-            BigHexInt absB = other;
-            absB.isNegative = false;
-            return *this - absB;
+BigHexInt& BigHexInt::operator+=(const BigHexInt& other) {
+    accumulate(other, other.isNegative);
+    return *this;
+}
+
+BigHexInt& BigHexInt::operator-=(const BigHexInt& other) {
+    accumulate(other, !other.isNegative);
+    return *this;
+}
+
+BigHexInt& BigHexInt::operator*=(const BigHexInt& other) {
+    *this = *this * other;
+    return *this;
+}
+
+BigHexInt& BigHexInt::operator%=(const BigHexInt& other) {
+    BigHexInt remainder;
+    divide(other, &remainder);
+    *this = std::move(remainder);
+    return *this;
+}
+
+// Shifts the magnitude left by a number of bits, the sign is kept
+BigHexInt& BigHexInt::operator<<=(int bits) {
+    if (bits <= 0 || isZero()) {
+        return *this;
+    }
+    int limbShift = bits / LIMB_BITS;
+    int bitShift = bits % LIMB_BITS;
+    int oldLength = length;
+    reserve(oldLength + limbShift + 1);
+
+    if (bitShift == 0) {
+        for (int i = oldLength - 1; i >= 0; i--) {
+            limbs[i + limbShift] = limbs[i];
+        }
+        length = oldLength + limbShift;
+    } else {
+        limbs[oldLength + limbShift] = limbs[oldLength - 1] >> (LIMB_BITS - bitShift);
+        for (int i = oldLength - 1; i > 0; i--) {
+            limbs[i + limbShift] = (limbs[i] << bitShift) | (limbs[i - 1] >> (LIMB_BITS - bitShift));
         }
+        limbs[limbShift] = limbs[0] << bitShift;
+        length = oldLength + limbShift + 1;
     }
-    
-    BigHexInt result;
-    std::fill(result.digits, result.digits + MAX_HEX_RESULT_SIZE, '0');
-    int carry = 0;
-    
-    for (int i = 0; i < HEX_SIZE; i++) {
-        int digitA = convertHexDigitToInt(digits[i]);
-        int digitB = convertHexDigitToInt(other.digits[i]);
-        int sum = digitA + digitB + carry;
-        result.digits[i] = HEX_DIGIT_STR[sum % 16];
-        carry = sum / 16;
+    std::fill(limbs, limbs + limbShift, 0);
+    trim();
+    return *this;
+}
+
+// Shifts the magnitude right by a number of bits (truncates toward zero)
+BigHexInt& BigHexInt::operator>>=(int bits) {
+    if (bits <= 0) {
+        return *this;
     }
-    
-    result.isNegative = isNegative;
-    
-    int actualLength = HEX_SIZE;
-    if (carry > 0 && actualLength < MAX_HEX_RESULT_SIZE) {
-        result.digits[actualLength] = HEX_DIGIT_STR[carry];
-        actualLength++;
+    int limbShift = bits / LIMB_BITS;
+    int bitShift = bits % LIMB_BITS;
+    if (limbShift >= length) {
+        length = 1;
+        limbs[0] = 0;
+        trim();
+        return *this;
     }
-    
-    while (actualLength > 1 && result.digits[actualLength-1] == '0') {
-        actualLength--;
+
+    int newLength = length - limbShift;
+    if (bitShift == 0) {
+        for (int i = 0; i < newLength; i++) {
+            limbs[i] = limbs[i + limbShift];
+        }
+    } else {
+        for (int i = 0; i < newLength; i++) {
+            Limb high = (i + limbShift + 1 < length) ? limbs[i + limbShift + 1] : 0;
+            limbs[i] = (limbs[i + limbShift] >> bitShift) | (high << (LIMB_BITS - bitShift));
+        }
     }
-    result.length = actualLength;
-    
+    length = newLength;
+    trim();
+    return *this;
+}
+
+BigHexInt BigHexInt::operator<<(int bits) const {
+    BigHexInt result(*this);
+    result <<= bits;
     return result;
 }
 
-BigHexInt BigHexInt::operator-(const BigHexInt& other) const {
-    if (isNegative != other.isNegative) {
-        BigHexInt absB = other;
-        absB.isNegative = !other.isNegative;
-        return *this + absB;
+BigHexInt BigHexInt::operator>>(int bits) const {
+    BigHexInt result(*this);
+    result >>= bits;
+    return result;
+}
+
+// out[0 .. n) = value in two's complement; a negative value is ~(magnitude - 1)
+static void toTwosComplement(const BigHexInt& value, Limb* out, int n) {
+    std::copy(value.limbs, value.limbs + value.length, out);
+    std::fill(out + value.length, out + n, 0);
+    if (value.isNegative) {
+        Limb unit = 1;
+        subLimbs(out, out, n, &unit, 1);
+        for (int i = 0; i < n; i++) {
+            out[i] = ~out[i];
+        }
     }
-    
-    BigHexInt result;
-    std::fill(result.digits, result.digits + MAX_HEX_RESULT_SIZE, '0');
-    int borrow = 0;
-    
-    int cmp = 0;
-    for (int i = HEX_SIZE - 1; i >= 0; i--) {
-        int digitA = convertHexDigitToInt(digits[i]);
-        int digitB = convertHexDigitToInt(other.digits[i]);
-        if (digitA != digitB) {
-            cmp = (digitA > digitB) ? 1 : -1;
-            break;
+}
+
+static inline Limb combineLimbs(Limb x, Limb y, int op) {
+    return (op == 0) ? (x & y) : (op == 1) ? (x | y) : (x ^ y);
+}
+
+// Non-negative operands combine their magnitudes directly. Otherwise both are widened
+// by one limb so the top limb holds only sign bits, combined in two's complement and
+// converted back, which also settles the sign of the result.
+void BigHexInt::bitwiseInPlace(const BigHexInt& other, BitwiseOp op) {
+    int code = (int)op;
+    if (!isNegative && !other.isNegative) {
+        if (op == BitwiseOp::And) {
+            length = std::min(length, other.length);
+            for (int i = 0; i < length; i++) {
+                limbs[i] &= other.limbs[i];
+            }
+        } else {
+            int otherLength = other.length;
+            const Limb* otherLimbs = other.limbs;
+            if (otherLength > length) {
+                resize(otherLength);
+            }
+            for (int i = 0; i < otherLength; i++) {
+                limbs[i] = combineLimbs(limbs[i], otherLimbs[i], code);
+            }
         }
+        trim();
+        return;
     }
-    
-    const BigHexInt *larger, *smaller;
-    if (cmp >= 0) {
-        larger = this;
-        smaller = &other;
-        result.isNegative = isNegative;
-    } else {
-        larger = &other;
-        smaller = this;
-        result.isNegative = !isNegative;
+
+    int n = std::max(length, other.length) + 1;
+    std::vector<Limb> x(n), y(n);
+    toTwosComplement(*this, x.data(), n);
+    toTwosComplement(other, y.data(), n);
+    for (int i = 0; i < n; i++) {
+        x[i] = combineLimbs(x[i], y[i], code);
     }
-    
-    for (int i = 0; i < HEX_SIZE; i++) {
-        int digitL = convertHexDigitToInt(larger->digits[i]);
-        int digitS = convertHexDigitToInt(smaller->digits[i]);
-        int diff = digitL - digitS - borrow;
-        
-        if (diff < 0) {
-            diff += 16;
-            borrow = 1;
-        } else {
-            borrow = 0;
+    bool negative = (x[n - 1] >> (LIMB_BITS - 1)) != 0;
+    if (negative) {
+        Limb unit = 1;
+        for (int i = 0; i < n; i++) {
+            x[i] = ~x[i];
         }
-        
-        result.digits[i] = HEX_DIGIT_STR[diff];
+        addLimbs(x.data(), x.data(), n, &unit, 1);
     }
-    
-    int actualLength = HEX_SIZE;
-    while (actualLength > 1 && result.digits[actualLength-1] == '0') {
-        actualLength--;
+    resize(n);
+    std::copy(x.begin(), x.end(), limbs);
+    isNegative = negative;
+    trim();
+}
+
+BigHexInt& BigHexInt::operator&=(const BigHexInt& other) {
+    bitwiseInPlace(other, BitwiseOp::And);
+    return *this;
+}
+
+BigHexInt& BigHexInt::operator|=(const BigHexInt& other) {
+    bitwiseInPlace(other, BitwiseOp::Or);
+    return *this;
+}
+
+BigHexInt& BigHexInt::operator^=(const BigHexInt& other) {
+    bitwiseInPlace(other, BitwiseOp::Xor);
+    return *this;
+}
+
+BigHexInt BigHexInt::operator&(const BigHexInt& other) const {
+    BigHexInt result(*this);
+    result &= other;
+    return result;
+}
+
+BigHexInt BigHexInt::operator|(const BigHexInt& other) const {
+    BigHexInt result(*this);
+    result |= other;
+    return result;
+}
+
+BigHexInt BigHexInt::operator^(const BigHexInt& other) const {
+    BigHexInt result(*this);
+    result ^= other;
+    return result;
+}
+
+// ~x = -x - 1: a non-negative x becomes -(x + 1), a negative one |x| - 1
+BigHexInt BigHexInt::operator~() const {
+    BigHexInt result(*this);
+    Limb unit = 1;
+    if (isNegative) {
+        subLimbs(result.limbs, result.limbs, result.length, &unit, 1);
+        result.isNegative = false;
+    } else {
+        result.resize(length + 1);
+        addLimbs(result.limbs, result.limbs, length + 1, &unit, 1);
+        result.isNegative = true;
     }
-    result.length = actualLength;
-    
+    result.trim();
     return result;
 }
 
-BigHexInt BigHexInt::clone() const {
-    BigHexInt result;
-    std::fill(result.digits, result.digits + MAX_HEX_RESULT_SIZE, '0');
+int BigHexInt::bitLength() const {
+    int used = length;
+    while (used > 1 && limbs[used - 1] == 0) {
+        used--;
+    }
+    if (limbs[used - 1] == 0) {
+        return 0;
+    }
+    return (used - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clzll(limbs[used - 1]));
+}
+
+bool BigHexInt::testBit(int index) const {
+    if (index < 0 || index / LIMB_BITS >= length) {
+        return false;
+    }
+    return (limbs[index / LIMB_BITS] >> (index % LIMB_BITS)) & 1;
+}
+
+int BigHexInt::popcount() const {
+    int count = 0;
     for (int i = 0; i < length; i++) {
-        result.digits[i] = digits[i];
+        count += __builtin_popcountll(limbs[i]);
     }
-    result.length = length;
-    result.isNegative = isNegative;
+    return count;
+}
+
+BigHexInt BigHexInt::operator+(const BigHexInt& other) const {
+    BigHexInt result(*this);
+    result += other;
+    return result;
+}
+
+BigHexInt BigHexInt::operator-(const BigHexInt& other) const {
+    BigHexInt result(*this);
+    result -= other;
     return result;
 }
 
+BigHexInt BigHexInt::clone() const {
+    return BigHexInt(*this);
+}
+
 void BigHexInt::shiftLeftInPlace(int n) {
-    if (length + n > HEX_SIZE) {
-        throw OverflowException("shift left operation");
-    }
+    reserve(length + n);
     
     for (int i = length - 1; i >= 0; i--) {
-        if (i + n < HEX_SIZE) {
-            digits[i + n] = digits[i];
-        }
+        limbs[i + n] = limbs[i];
     }
 
     for (int i = 0; i < n; i++) {
-        digits[i] = '0';
+        limbs[i] = 0;
     }
 
     length = length + n;
-    if (length > HEX_SIZE) {
-        length = HEX_SIZE;
-    }
 }
 
 BigHexInt BigHexInt::shiftLeft(int n) const {
@@ -425,11 +692,9 @@ BigHexInt BigHexInt::shiftLeft(int n) const {
 
 BigHexInt BigHexInt::getLower(int n) const {
     BigHexInt res;
-    std::fill(res.digits, res.digits + MAX_HEX_RESULT_SIZE, '0');
     int actual = std::min(length, n);
-    for (int i = 0; i < actual; i++) {
-        res.digits[i] = digits[i];
-    }
+    res.reserve(actual);
+    std::copy(limbs, limbs + actual, res.limbs);
     res.length = (actual == 0) ? 1 : actual;
     res.isNegative = false;
     return res;
@@ -437,17 +702,14 @@ BigHexInt BigHexInt::getLower(int n) const {
 
 BigHexInt BigHexInt::getHigher(int n) const {
     BigHexInt res;
-    std::fill(res.digits, res.digits + MAX_HEX_RESULT_SIZE, '0');
     if (length <= n) {
         res.length = 1;
-        res.digits[0] = '0';
         res.isNegative = false;
         return res;
     }
     int newLength = length - n;
-    for (int i = 0; i < newLength; i++) {
-        res.digits[i] = digits[i+n];
-    }
+    res.reserve(newLength);
+    std::copy(limbs + n, limbs + length, res.limbs);
     res.length = newLength;
     res.isNegative = false;
     return res;
@@ -456,178 +718,357 @@ BigHexInt BigHexInt::getHigher(int n) const {
 BigHexInt BigHexInt::pad(int targetLen) const {
     BigHexInt res = clone();
     if (res.length < targetLen) {
-        for (int i = res.length; i < targetLen; i++) {
-            res.digits[i] = '0';
-        }
-        res.length = targetLen;
+        res.resize(targetLen);
     }
     return res;
 }
 
 BigHexInt BigHexInt::multiplyNaive(const BigHexInt& other) const {
     BigHexInt result;
-    std::fill(result.digits, result.digits + MAX_HEX_RESULT_SIZE, '0');
-    result.length = length + other.length;
     result.isNegative = isNegative != other.isNegative;
 
-    if (result.length >= MAX_HEX_RESULT_SIZE) {
-        throw OverflowException("naive multiplication");
-    }
+    int aLen = length, bLen = other.length;
+    while (aLen > 1 && limbs[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && other.limbs[bLen - 1] == 0) bLen--;
 
-    for (int i = 0; i < length; i++) {
-        int carry = 0;
-        int a_digit = convertHexDigitToInt(digits[i]);
-        for (int j = 0; j < other.length || carry; j++) {
-            int b_digit = (j < other.length) ? convertHexDigitToInt(other.digits[j]) : 0;
-            int current = convertHexDigitToInt(result.digits[i+j]);
-            int prod = current + a_digit * b_digit + carry;
-            result.digits[i+j] = HEX_DIGIT_STR[prod % 16];
-            carry = prod / 16;
-        }
+    result.reserve(aLen + bLen);
+    mulLimbs(result.limbs, limbs, aLen, other.limbs, bLen);
+    result.length = aLen + bLen;
+    result.trim();
+    return result;
+}
+
+BigHexInt BigHexInt::multiplyNtt(const BigHexInt& other) const {
+    int aLen = length, bLen = other.length;
+    while (aLen > 1 && limbs[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && other.limbs[bLen - 1] == 0) bLen--;
+    if (!nttSupports(aLen, bLen)) {
+        return *this * other;
     }
 
-    while (result.length > 1 && result.digits[result.length-1] == '0') {
-        result.length--;
+    BigHexInt result;
+    result.isNegative = isNegative != other.isNegative;
+    result.reserve(aLen + bLen);
+    if (this == &other) {
+        nttSqrLimbs(result.limbs, limbs, aLen);
+    } else {
+        nttMulLimbs(result.limbs, limbs, aLen, other.limbs, bLen);
     }
+    result.length = aLen + bLen;
+    result.trim();
     return result;
 }
 
-BigHexInt BigHexInt::karatsuba(const BigHexInt& other) const {
-    // Check if result is already memoized
-    std::string thisStr = this->toString();
-    std::string otherStr = other.toString();
-    
-    // Normalize the order for consistent memoization
-    if (thisStr > otherStr) {
-        std::swap(thisStr, otherStr);
+// Multiplication dispatcher for magnitudes: schoolbook, Karatsuba, Toom-3 or NTT by
+// operand size, with the crossovers taken from multiplyThresholds
+BigHexInt BigHexInt::multiplyMagnitude(const BigHexInt& other) const {
+    // Base cases
+    if (isZero() || other.isZero()) {
+        return BigHexInt();
     }
-    
-    std::pair<std::string, std::string> key = {thisStr, otherStr};
-    
-    // Check if we already computed this multiplication
-    auto it = karatsubaMemo.find(key);
-    if (it != karatsubaMemo.end()) {
-        // Found in memoization table, create BigHexInt from stored result
-        return BigHexInt::createFromString(it->second);
+
+    // Small products are cheaper to recompute than to hash, so they skip the cache
+    if (length <= multiplyThresholds.karatsuba || other.length <= multiplyThresholds.karatsuba) {
+        BigHexInt result = multiplyNaive(other);
+        result.isNegative = false;
+        return result;
     }
 
-    BigHexInt result;
-    
-    // Base cases
-    if ((length == 1 && digits[0] == '0') ||
-        (other.length == 1 && other.digits[0] == '0')) {
-        BigHexInt zero;
-        std::fill(zero.digits, zero.digits + MAX_HEX_RESULT_SIZE, '0');
-        zero.length = 1;
-        zero.isNegative = false;
-        
-        // Memoize the result
-        karatsubaMemo[key] = zero.toString();
-        return zero;
+    // Products this large are never repeated, so they skip the cache and the journal
+    if (std::min(length, other.length) >= multiplyThresholds.ntt && nttSupports(length, other.length)) {
+        BigHexInt result = multiplyNtt(other);
+        result.isNegative = false;
+        return result;
     }
 
-    if (length <= KARATSUBA_THRESHOLD || other.length <= KARATSUBA_THRESHOLD) {
-        result = multiplyNaive(other);
-        // Memoize the result
-        karatsubaMemo[key] = result.toString();
+    // A much longer operand is cut into balanced pieces instead of padding the shorter
+    // one; the pieces come back through here and are cached individually
+    int aLen = length, bLen = other.length;
+    while (aLen > 1 && limbs[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && other.limbs[bLen - 1] == 0) bLen--;
+    if (aLen >= 2 * bLen) {
+        return multiplyUnbalanced(other, aLen, bLen);
+    }
+    if (bLen >= 2 * aLen) {
+        return other.multiplyUnbalanced(*this, bLen, aLen);
+    }
+
+    // Sub-products running as thread pool tasks neither read nor fill the cache and the
+    // journal, which are not thread-safe
+    bool memoize = !ThreadPool::inTask();
+
+    // Check if we already computed this multiplication
+    BigHexInt result;
+    if (memoize && karatsubaCache.lookup(*this, other, result)) {
         return result;
     }
 
-    int n = std::max(length, other.length);
-    BigHexInt x = pad(n);
-    BigHexInt y = other.pad(n);
+    // Serve misses from the persisted snapshot and keep the product warm in memory.
+    // Hits last used on an earlier day are journaled again so the age policy keeps them.
+    uint32_t lastUsedDay;
+    if (memoize && karatsubaCache.isEnabled() && memoSnapshot.find(*this, other, result, &lastUsedDay)) {
+        karatsubaCache.insert(*this, other, result);
+        uint32_t today = MemoSnapshot::currentDay();
+        if (lastUsedDay != today) {
+            memoJournal.append(*this, other, result, today);
+        }
+        return result;
+    }
 
-    int m = n / 2;
+    // Toom-3 only pays off once both operands are long
+    result = (std::min(length, other.length) >= multiplyThresholds.toom3) ? toom3(other) : karatsubaSplit(other);
 
-    BigHexInt low1 = x.getLower(m);
-    BigHexInt high1 = x.getHigher(m);
-    BigHexInt low2 = y.getLower(m);
-    BigHexInt high2 = y.getHigher(m);
+    // Memoize the result and queue it for the on-disk journal
+    if (memoize) {
+        karatsubaCache.insert(*this, other, result);
+        if (karatsubaCache.isEnabled()) {
+            memoJournal.append(*this, other, result, MemoSnapshot::currentDay());
+        }
+    }
+    return result;
+}
 
-    BigHexInt z0 = low1.karatsuba(low2);
-    BigHexInt z2 = high1.karatsuba(high2);
+// Magnitude of *this (longLen limbs) times shorter (shortLen limbs) as a sum of
+// shortLen x shortLen products, one per chunk of *this, each added at its chunk's offset
+BigHexInt BigHexInt::multiplyUnbalanced(const BigHexInt& shorter, int longLen, int shortLen) const {
+    BigHexInt result;
+    result.resize(longLen + shortLen);
+    BigHexInt chunk;
+    for (int offset = 0; offset < longLen; offset += shortLen) {
+        int chunkLen = std::min(shortLen, longLen - offset);
+        chunk.resize(chunkLen);
+        std::copy(limbs + offset, limbs + offset + chunkLen, chunk.limbs);
+        BigHexInt part = chunk.multiplyMagnitude(shorter);
+        addLimbs(result.limbs + offset, result.limbs + offset, longLen + shortLen - offset, part.limbs, part.length);
+    }
+    result.trim();
+    return result;
+}
 
-    BigHexInt sum1 = low1 + high1;
-    BigHexInt sum2 = low2 + high2;
-    BigHexInt z1 = sum1.karatsuba(sum2);
+// Karatsuba on the magnitudes' limbs in place: the product and one workspace for the
+// whole recursion tree are allocated here, the kernel itself never allocates or copies
+BigHexInt BigHexInt::karatsubaSplit(const BigHexInt& other) const {
+    int aLen = length, bLen = other.length;
+    while (aLen > 1 && limbs[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && other.limbs[bLen - 1] == 0) bLen--;
+    int n = std::max(aLen, bLen);
+    if (n < 2) {
+        BigHexInt result = multiplyNaive(other);
+        result.isNegative = false;
+        return result;
+    }
 
-    z1 = z1 - z2;
-    z1 = z1 - z0;
+    // The kernel splits equal lengths, so the shorter operand is zero-extended into the workspace
+    int scratchLimbs = karatsubaScratchLimbs(n, multiplyThresholds.karatsuba);
+    std::vector<Limb> workspace(scratchLimbs + (aLen != bLen ? n : 0), 0);
+    const Limb* a = limbs;
+    const Limb* b = other.limbs;
+    if (aLen < n) {
+        std::copy(limbs, limbs + aLen, workspace.begin() + scratchLimbs);
+        a = workspace.data() + scratchLimbs;
+    } else if (bLen < n) {
+        std::copy(other.limbs, other.limbs + bLen, workspace.begin() + scratchLimbs);
+        b = workspace.data() + scratchLimbs;
+    }
 
-    BigHexInt part1 = z2.shiftLeft(2 * m);
-    BigHexInt part2 = z1.shiftLeft(m);
-    BigHexInt temp = part1 + part2;
-    result = temp + z0;
+    BigHexInt result;
+    result.reserve(2 * n);
+    karatsubaMulLimbs(result.limbs, a, b, n, multiplyThresholds.karatsuba, multiplyThresholds.parallel, workspace.data());
+    result.length = 2 * n;
+    result.trim();
+    return result;
+}
 
-    while (result.length > 1 && result.digits[result.length-1] == '0') {
-        result.length--;
+// Toom-Cook 3-way on magnitudes: split both operands into three k-limb parts,
+// evaluate at 0, 1, -1, -2 and infinity, multiply pointwise and interpolate with
+// Bodrato's sequence, whose only divisions are exact ones by 2 and 3
+BigHexInt BigHexInt::toom3(const BigHexInt& other) const {
+    int n = std::max(length, other.length);
+    int k = (n + 2) / 3;
+
+    BigHexInt a0 = getLower(k);
+    BigHexInt a1 = getHigher(k).getLower(k);
+    BigHexInt a2 = getHigher(2 * k);
+    BigHexInt b0 = other.getLower(k);
+    BigHexInt b1 = other.getHigher(k).getLower(k);
+    BigHexInt b2 = other.getHigher(2 * k);
+
+    // p(1) = a0 + a1 + a2, p(-1) = a0 - a1 + a2, p(-2) = a0 - 2a1 + 4a2
+    BigHexInt p1 = a0 + a2;
+    BigHexInt pm1 = p1 - a1;
+    p1 += a1;
+    BigHexInt pm2 = pm1 + a2;
+    pm2 <<= 1;
+    pm2 -= a0;
+    BigHexInt q1 = b0 + b2;
+    BigHexInt qm1 = q1 - b1;
+    q1 += b1;
+    BigHexInt qm2 = qm1 + b2;
+    qm2 <<= 1;
+    qm2 -= b0;
+
+    // The five pointwise products are independent, so large ones run as pool tasks
+    BigHexInt r0, r1, rm1, r2, rInf;
+    std::vector<std::function<void()>> products = {
+        [&]() { r0 = a0 * b0; },
+        [&]() { r1 = p1 * q1; },
+        [&]() { rm1 = pm1 * qm1; },
+        [&]() { r2 = pm2 * qm2; },
+        [&]() { rInf = a2 * b2; }
+    };
+    if (n >= multiplyThresholds.parallel) {
+        threadPool.run(products);
+    } else {
+        for (const std::function<void()>& product : products) {
+            product();
+        }
     }
-    
-    // Memoize the result
-    karatsubaMemo[key] = result.toString();
+
+    // Interpolation; every intermediate division is exact
+    BigHexInt r3 = r2 - r1;
+    r3.divideSmallInPlace(3);
+    r1 -= rm1;
+    r1 >>= 1;
+    r2 = rm1 - r0;
+    r3 = r2 - r3;
+    r3 >>= 1;
+    r3 += rInf;
+    r3 += rInf;
+    r2 += r1;
+    r2 -= rInf;
+    r1 -= r3;
+
+    // result = ((((rInf * B^k + r3) * B^k + r2) * B^k + r1) * B^k + r0)
+    BigHexInt result = std::move(rInf);
+    result.shiftLeftInPlace(k);
+    result += r3;
+    result.shiftLeftInPlace(k);
+    result += r2;
+    result.shiftLeftInPlace(k);
+    result += r1;
+    result.shiftLeftInPlace(k);
+    result += r0;
+    result.isNegative = false;
     return result;
 }
 
-BigHexInt BigHexInt::operator*(const BigHexInt& other) const {
+// Divides the magnitude by a single limb in place and returns the remainder
+Limb BigHexInt::divideSmallInPlace(Limb divisor) {
+    DoubleLimb remainder = 0;
+    for (int i = length - 1; i >= 0; i--) {
+        DoubleLimb cur = (remainder << LIMB_BITS) | limbs[i];
+        limbs[i] = (Limb)(cur / divisor);
+        remainder = cur % divisor;
+    }
+    trim();
+    return (Limb)remainder;
+}
+
+BigHexInt BigHexInt::multiply(const BigHexInt& other, MultiplyAlgorithm algorithm) const {
     BigHexInt result;
-    
-    // Use Karatsuba for larger numbers (when combined length > 24)
-    // if (length + other.length > 8) {
-    //     result = karatsuba(other);
-    // } else {
-    //     result = multiplyNaive(other);
-    // }
-    result = karatsuba(other);
+    switch (algorithm) {
+        case MultiplyAlgorithm::Schoolbook:
+            result = multiplyNaive(other);
+            break;
+        case MultiplyAlgorithm::Karatsuba:
+            result = karatsubaSplit(other);
+            break;
+        case MultiplyAlgorithm::Toom3:
+            result = toom3(other);
+            break;
+        case MultiplyAlgorithm::Ntt:
+            return multiplyNtt(other);
+        default:
+            return *this * other;
+    }
     result.isNegative = isNegative != other.isNegative;
+    result.trim();
     return result;
 }
 
-bool BigHexInt::isGreaterOrEqual(const BigHexInt& other) const {
-    if (length != other.length) {
-        return length > other.length;
+// Both short products zero-extend the operands to n limbs
+BigHexInt BigHexInt::mulLow(const BigHexInt& other, int n) const {
+    if (n <= 0) {
+        throw InvalidInputException("Short product length must be positive: " + std::to_string(n));
     }
-    
-    for (int i = length - 1; i >= 0; i--) {
-        int digitA = convertHexDigitToInt(digits[i]);
-        int digitB = convertHexDigitToInt(other.digits[i]);
-        if (digitA != digitB) {
-            return digitA > digitB;
-        }
+    int base = multiplyThresholds.karatsuba;
+    std::vector<Limb> a(n, 0), b(n, 0), work(shortProductScratchLimbs(n, base));
+    std::copy(limbs, limbs + std::min(length, n), a.begin());
+    std::copy(other.limbs, other.limbs + std::min(other.length, n), b.begin());
+
+    BigHexInt result;
+    result.resize(n);
+    mulLowLimbs(result.limbs, a.data(), b.data(), n, base, work.data());
+    result.trim();
+    return result;
+}
+
+BigHexInt BigHexInt::mulHigh(const BigHexInt& other, int n) const {
+    if (n <= 0) {
+        throw InvalidInputException("Short product length must be positive: " + std::to_string(n));
+    }
+    int aLen = length, bLen = other.length;
+    while (aLen > 1 && limbs[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && other.limbs[bLen - 1] == 0) bLen--;
+    if (aLen > n || bLen > n) {
+        throw InvalidInputException("High short product operands must fit in " + std::to_string(n) + " limbs");
     }
-    return true;  // Equal
+    int base = multiplyThresholds.karatsuba;
+    std::vector<Limb> a(n, 0), b(n, 0), work(shortProductScratchLimbs(n, base));
+    std::copy(limbs, limbs + aLen, a.begin());
+    std::copy(other.limbs, other.limbs + bLen, b.begin());
+
+    BigHexInt result;
+    result.resize(n);
+    mulHighLimbs(result.limbs, a.data(), b.data(), n, base, work.data());
+    result.trim();
+    return result;
 }
 
-// BigHexInt BigHexInt::divide(const BigHexInt& divisor, BigHexInt* remainder) const {
-//     if (divisor.isZero()) {
-//         throw DivisionByZeroException();
-//     }
-    
-//     BigHexInt quotient;
-//     std::fill(quotient.digits, quotient.digits + MAX_HEX_RESULT_SIZE, '0');
-//     quotient.length = 1;
-//     quotient.isNegative = isNegative != divisor.isNegative;
-    
-//     int cmp = compare(divisor);
-//     if (cmp == 0) {
-//         quotient.digits[0] = '1';
-//         if (remainder != nullptr) {
-//             std::fill(remainder->digits, remainder->digits + MAX_HEX_RESULT_SIZE, '0');
-//             remainder->length = 1;
-//             remainder->isNegative = false;
-//         }
-//         return quotient;
-//     } else if ((cmp < 0 && !isNegative && !divisor.isNegative) || 
-//                (cmp > 0 && isNegative && divisor.isNegative)) {
-//         quotient.digits[0] = '0';
-//         if (remainder != nullptr) {
-//             *remainder = *this;
-//         }
-//         return quotient;
-//     }
-    
-//     // Simplified division - for full implementation, proper long division needed
-//     return quotient;
-// }
+// Karatsuba on a single operand: the three half-size products are all squares.
+// Squares in exponentiation never repeat, so this path does not use the memo cache.
+BigHexInt BigHexInt::karatsubaSquare() const {
+    int n = length;
+    while (n > 1 && limbs[n - 1] == 0) n--;
+
+    if (n >= multiplyThresholds.ntt && nttSupports(n, n)) {
+        return multiplyNtt(*this);
+    }
+
+    BigHexInt result;
+    result.reserve(2 * n);
+    if (n <= multiplyThresholds.karatsubaSquare || n < 2) {
+        sqrLimbs(result.limbs, limbs, n);
+    } else {
+        std::vector<Limb> workspace(karatsubaScratchLimbs(n, multiplyThresholds.karatsubaSquare));
+        karatsubaSqrLimbs(result.limbs, limbs, n, multiplyThresholds.karatsubaSquare, multiplyThresholds.parallel,
+                          workspace.data());
+    }
+    result.length = 2 * n;
+    result.trim();
+    return result;
+}
+
+BigHexInt BigHexInt::square() const {
+    BigHexInt result = karatsubaSquare();
+    result.isNegative = false;
+    return result;
+}
+
+BigHexInt BigHexInt::operator*(const BigHexInt& other) const {
+    if (&other == this) {
+        return square();
+    }
+
+    BigHexInt result = multiplyMagnitude(other);
+    result.isNegative = isNegative != other.isNegative;
+    result.trim();
+    return result;
+}
+
+bool BigHexInt::isGreaterOrEqual(const BigHexInt& other) const {
+    return compareLimbs(limbs, length, other.limbs, other.length) >= 0;
+}
 
 BigHexInt BigHexInt::divide(const BigHexInt& divisor, BigHexInt* remainder) const {
     if (divisor.isZero()) {
@@ -643,34 +1084,22 @@ BigHexInt BigHexInt::divide(const BigHexInt& divisor, BigHexInt* remainder) cons
         return zero;
     }
     
-    // Create absolute values for calculation
-    BigHexInt dividend = *this;
-    BigHexInt divisorAbs = divisor;
-    dividend.isNegative = false;
-    divisorAbs.isNegative = false;
-    
     // Initialize quotient
     BigHexInt quotient;
-    std::fill(quotient.digits, quotient.digits + MAX_HEX_RESULT_SIZE, '0');
-    quotient.length = 1;
     quotient.isNegative = this->isNegative != divisor.isNegative;
     
     // Quick comparison checks
-    int cmp = dividend.compare(divisorAbs);
+    int cmp = compareLimbs(limbs, length, divisor.limbs, divisor.length);
     if (cmp == 0) {
         // dividend equals divisor
-        quotient.digits[0] = '1';
+        quotient.limbs[0] = 1;
         quotient.length = 1;
         if (remainder != nullptr) {
-            std::fill(remainder->digits, remainder->digits + MAX_HEX_RESULT_SIZE, '0');
-            remainder->length = 1;
-            remainder->isNegative = false;
+            *remainder = BigHexInt();
         }
         return quotient;
     } else if (cmp < 0) {
         // dividend < divisor
-        quotient.digits[0] = '0';
-        quotient.length = 1;
         quotient.isNegative = false;
         if (remainder != nullptr) {
             *remainder = *this;
@@ -678,66 +1107,25 @@ BigHexInt BigHexInt::divide(const BigHexInt& divisor, BigHexInt* remainder) cons
         return quotient;
     }
     
-    // Perform long division
-    BigHexInt currentDividend;
-    std::fill(currentDividend.digits, currentDividend.digits + MAX_HEX_RESULT_SIZE, '0');
-    currentDividend.length = 1;
-    currentDividend.isNegative = false;
-    
-    std::fill(quotient.digits, quotient.digits + MAX_HEX_RESULT_SIZE, '0');
-    int quotientPos = 0;
-    
-    // Process each digit of the dividend from left to right
-    for (int i = dividend.length - 1; i >= 0; i--) {
-        // Shift current dividend left and add next digit
-        if (!currentDividend.isZero()) {
-            // Shift left by one hex digit
-            for (int j = currentDividend.length; j > 0; j--) {
-                currentDividend.digits[j] = currentDividend.digits[j-1];
-            }
-            currentDividend.digits[0] = dividend.digits[i];
-            currentDividend.length++;
-        } else {
-            // First non-zero digit
-            currentDividend.digits[0] = dividend.digits[i];
-            currentDividend.length = 1;
-        }
-        
-        // Find how many times divisor goes into current dividend
-        int count = 0;
-        while (currentDividend.compare(divisorAbs) >= 0) {
-            // Subtract divisor from current dividend
-            BigHexInt temp = currentDividend - divisorAbs;
-            currentDividend = temp;
-            count++;
-        }
-        
-        // Store the count in quotient
-        if (count > 0 || quotientPos > 0) {
-            quotient.digits[quotientPos] = convertIntToHexChar(count);
-            quotientPos++;
-        }
-    }
-    
-    // Set quotient length and handle case where quotient is zero
-    if (quotientPos == 0) {
-        quotient.digits[0] = '0';
-        quotient.length = 1;
-        quotient.isNegative = false;
-    } else {
-        quotient.length = quotientPos;
-        // Reverse the quotient digits since we built it backwards
-        for (int i = 0; i < quotient.length / 2; i++) {
-            char temp = quotient.digits[i];
-            quotient.digits[i] = quotient.digits[quotient.length - 1 - i];
-            quotient.digits[quotient.length - 1 - i] = temp;
-        }
-    }
+    // Schoolbook long division on whole limbs
+    int dividendLength = length;
+    while (dividendLength > 1 && limbs[dividendLength - 1] == 0) dividendLength--;
+    int divisorLength = divisor.length;
+    while (divisorLength > 1 && divisor.limbs[divisorLength - 1] == 0) divisorLength--;
+
+    quotient.resize(dividendLength - divisorLength + 1);
+    BigHexInt rest;
+    rest.resize(divisorLength);
+    BigHexInt work;
+    work.resize(dividendLength + divisorLength + 1);
+    divLimbs(quotient.limbs, rest.limbs, limbs, dividendLength, divisor.limbs, divisorLength, work.limbs);
+    quotient.trim();
     
     // Set remainder if requested
     if (remainder != nullptr) {
-        *remainder = currentDividend;
-        remainder->isNegative = this->isNegative && !remainder->isZero();
+        rest.isNegative = this->isNegative;
+        rest.trim();
+        *remainder = std::move(rest);
     }
     
     return quotient;
@@ -755,16 +1143,16 @@ BigHexInt BigHexInt::operator%(const BigHexInt& other) const {
 
 bool BigHexInt::isZero() const {
     for (int i = 0; i < length; i++) {
-        if (digits[i] != '0') return false;
+        if (limbs[i] != 0) return false;
     }
     return true;
 }
 
 bool BigHexInt::isOne() const {
     if (length < 1) return false;
-    if (digits[0] != '1') return false;
+    if (limbs[0] != 1) return false;
     for (int i = 1; i < length; i++) {
-        if (digits[i] != '0') return false;
+        if (limbs[i] != 0) return false;
     }
     return true;
 }
@@ -787,69 +1175,6 @@ bool BigHexInt::isValidInput(const std::string& str) {
     return true;
 }
 
-void initializeLookupTable() {
-    try {
-        for (int i = 0; i < HEX_LOOKUP_SIZE; i++) {
-            for (int j = 0; j < HEX_LOOKUP_SIZE; j++) {
-                hexMultiplyLookup[i][j] = -1;
-            }
-        }
-
-        std::ifstream file(LOOKUP_FILE);
-        if (!file.is_open()) {
-            std::cout << "Warning: Lookup file not found. Will create new one on exit." << std::endl;
-            return;
-        }
-
-        int i_val, j_val, product_val;
-        char colon1, colon2;
-        while (file >> i_val >> colon1 >> j_val >> colon2 >> product_val) {
-            if (i_val >= 0 && i_val < HEX_LOOKUP_SIZE && 
-                j_val >= 0 && j_val < HEX_LOOKUP_SIZE) {
-                hexMultiplyLookup[i_val][j_val] = product_val;
-            }
-        }
-        file.close();
-        std::cout << "Lookup table loaded successfully." << std::endl;
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Error initializing lookup table: " << e.what() << std::endl;
-    }
-}
-
-
-void closeAndUpdateFile() {
-    try {
-        std::cout << "Updating memoization file..." << std::endl;
-        
-        std::ofstream file(LOOKUP_FILE, std::ios::app);
-        if (!file.is_open()) {
-            throw FileIOException(LOOKUP_FILE, "open for writing");
-        }
-
-        // Write new lookup table entries
-        for (int i = 0; i < HEX_LOOKUP_SIZE; i++) {
-            for (int j = 0; j < HEX_LOOKUP_SIZE; j++) {
-                if (hexMultiplyLookup[i][j] != -1) {
-                    file << i << ":" << j << ":" << hexMultiplyLookup[i][j] << std::endl;
-                }
-            }
-        }
-
-        // Write Karatsuba memoization results
-        for (const auto& entry : karatsubaMemo) {
-            file << "KARATSUBA:" << entry.first.first << ":" << entry.first.second 
-                 << ":" << entry.second << std::endl;
-        }
-
-        file.close();
-        std::cout << "Memoization file updated successfully." << std::endl;
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Error updating memoization file: " << e.what() << std::endl;
-    }
-}
-
 std::pair<std::string, std::string> getTwoValidNumbers() {
     std::string num1, num2;
     
@@ -974,7 +1299,7 @@ std::pair<std::string, std::string> getTwoValidNumbers() {
 
 //     return 0;
 // }
-BigHexInt BigHexInt::modPow(const BigHexInt& exponent, const BigHexInt& modulus) const {
+BigHexInt BigHexInt::modPow(const BigHexInt& exponent, const BigHexInt& modulus, ModularReducer reducer) const {
     // Handle edge cases
     if (modulus.isZero()) {
         throw std::invalid_argument("Modulus cannot be zero");
@@ -1002,83 +1327,47 @@ BigHexInt BigHexInt::modPow(const BigHexInt& exponent, const BigHexInt& modulus)
     if (base.isNegative) {
         // Convert negative base to positive equivalent in modular arithmetic
         base.isNegative = false;
-        BigHexInt temp = base % modulus;
-        base = modulus - temp;
+        base %= modulus;
+        if (!base.isZero()) {
+            BigHexInt temp = modulus;
+            temp.isNegative = false;
+            temp -= base;
+            base = std::move(temp);
+        }
     } else {
-        base = base % modulus;
+        base %= modulus;
     }
     
     if (base.isZero()) {
         return BigHexInt("0");
     }
-    
-    BigHexInt result("1");
-    BigHexInt exp = exponent;
-    
-    // Binary exponentiation with modular reduction
-    while (!exp.isZero()) {
-        // If exponent is odd, multiply result by current base
-        if (exp.isOdd()) {
-            result = (result * base) % modulus;
-        }
-        
-        // Square the base and halve the exponent
-        base = (base * base) % modulus;
-        exp = exp.divideByTwo();
-    }
-    
-    return result;
-}
-bool BigHexInt::isOdd() const {
-    if (length == 0) return false;
-    
-    // Check the least significant digit
-    char lastDigit = digits[0];
-    int lastDigitValue = convertHexDigitToInt(lastDigit);
-    
-    return (lastDigitValue & 1) == 1;
-}
 
-// Helper function to divide a BigHexInt by 2 (right shift by 1 bit)
-BigHexInt BigHexInt::divideByTwo() const {
-    if (isZero()) {
-        return BigHexInt("0");
+    // Odd moduli (every DH prime) reduce without division in Montgomery form, the rest with Barrett
+    if (reducer == ModularReducer::Automatic) {
+        reducer = modulus.isOdd() ? ModularReducer::Montgomery : ModularReducer::Barrett;
     }
-    
-    BigHexInt result;
-    std::fill(result.digits, result.digits + MAX_HEX_RESULT_SIZE, '0');
-    result.isNegative = isNegative;
-    
-    int carry = 0;
-    int resultLength = 0;
-    
-    // Process digits from most significant to least significant
-    for (int i = length - 1; i >= 0; i--) {
-        int digitValue = convertHexDigitToInt(digits[i]);
-        digitValue += carry * 16; // Add carry from previous position
-        
-        int newDigit = digitValue / 2;
-        carry = digitValue % 2;
-        
-        if (newDigit > 0 || resultLength > 0) {
-            result.digits[resultLength] = convertIntToHexChar(newDigit);
-            resultLength++;
-        }
+    if (reducer == ModularReducer::Montgomery) {
+        return base.modPow(exponent, MontgomeryContext(modulus));
     }
-    
-    if (resultLength == 0) {
-        result.digits[0] = '0';
-        result.length = 1;
-        result.isNegative = false;
-    } else {
-        result.length = resultLength;
-        // Reverse the result since we built it backwards
-        for (int i = 0; i < result.length / 2; i++) {
-            char temp = result.digits[i];
-            result.digits[i] = result.digits[result.length - 1 - i];
-            result.digits[result.length - 1 - i] = temp;
-        }
+    if (reducer == ModularReducer::Barrett) {
+        return base.modPow(exponent, BarrettContext(modulus));
     }
     
-    return result;
-}
\ No newline at end of file
+    // Sliding window exponentiation with a full multiply and % per step
+    return windowedPow(base, BigHexInt("1"), exponent,
+        [&modulus](BigHexInt& out, const BigHexInt& a, const BigHexInt& b) {
+            out = (&a == &b) ? a.square() : a * b;
+            out %= modulus;
+        });
+}
+BigHexInt BigHexInt::modPow(const BigHexInt& exponent, const MontgomeryContext& context) const {
+    return context.modPow(*this, exponent);
+}
+
+BigHexInt BigHexInt::modPow(const BigHexInt& exponent, const BarrettContext& context) const {
+    return context.modPow(*this, exponent);
+}
+
+bool BigHexInt::isOdd() const {
+    return (limbs[0] & 1) == 1;
+}
@@ -9,20 +9,35 @@
 #include <algorithm>
 #include <map>
 #include <stdexcept>
+#include "exceptions.hpp"
+#include <cstdint>
+#include <cstdio>
 
 //constants declared
 constexpr const char* LOOKUP_FILE = "numberstorage";
 constexpr const char* HEX_DIGIT_STR = "0123456789abcdef";
 constexpr int MAX_DIGITS = 618;
-constexpr int HEX_SIZE = 64;
-constexpr int MAX_HEX_RESULT_SIZE = 128;
 constexpr int HEX_LOOKUP_SIZE = 256;
 constexpr int MAX_BINARY_SIZE = 1024;
 constexpr int MAX_BINARY_RESULT_SIZE = 2048;
-constexpr int KARATSUBA_THRESHOLD = 4;
+// Default multiplication crossovers in limbs, used until a tuned profile is loaded (see MultiplyTuning.hpp)
+constexpr int KARATSUBA_THRESHOLD = 24;        // schoolbook multiplication up to here
+constexpr int TOOM3_THRESHOLD = 512;           // Toom-3 overtakes the Karatsuba split here
+constexpr int KARATSUBA_SQUARE_THRESHOLD = 48; // schoolbook squaring is cheap enough to win up to here
+constexpr int NTT_THRESHOLD = 32768;           // the three-prime NTT replaces Toom-3 from here
+constexpr int PARALLEL_MULTIPLY_THRESHOLD = 1024; // sub-products become thread pool tasks from here
+constexpr int LIMB_BITS = 64;
+constexpr int HEX_DIGITS_PER_LIMB = 16;
+constexpr int INLINE_LIMBS = 16;     // values up to 1024 bits never touch the heap
 
-// Global memoization map for Karatsuba multiplication
-extern std::map<std::pair<std::string, std::string>, std::string> karatsubaMemo;
+// Decimal BigInt packs 9 decimal digits into each 32-bit limb
+constexpr int DECIMAL_DIGITS_PER_LIMB = 9;
+constexpr uint32_t DECIMAL_LIMB_BASE = 1000000000;
+constexpr int MAX_DECIMAL_LIMBS = (MAX_DIGITS + DECIMAL_DIGITS_PER_LIMB - 1) / DECIMAL_DIGITS_PER_LIMB;
+
+// Machine word used for BigHexInt limbs and its double-width product type
+typedef uint64_t Limb;
+typedef unsigned __int128 DoubleLimb;
 
 // Global lookup table for isHex multiplication
 extern int hexMultiplyLookup[HEX_LOOKUP_SIZE][HEX_LOOKUP_SIZE];
@@ -39,10 +54,11 @@ std::pair<std::string, std::string> getTwoValidNumbers();
 
 //class declarations
 /*<----------------- BIG INT CLASS ------------------>*/
+// Magnitude is stored in base 10^9 limbs, least significant limb first.
 class BigInt {
 public:
-    char digits[MAX_DIGITS];
-    int length;
+    uint32_t limbs[MAX_DECIMAL_LIMBS];
+    int length;          // limbs in use, always >= 1
     bool isNegative;
 
     BigInt();       
@@ -52,30 +68,102 @@ public:
     BigInt operator+(const BigInt& other) const;
     BigInt operator-(const BigInt& other) const;
     BigInt operator*(const BigInt& other) const;
+    BigInt& operator+=(const BigInt& other);
+    BigInt& operator-=(const BigInt& other);
+    BigInt& operator*=(const BigInt& other);
     int compare(const BigInt& other) const;
     void print() const;
     static bool isValidInput(const std::string& str);
+
+private:
+    void trim();
+    void accumulate(const BigInt& other, bool otherNegative);
 };
 
 
 
 
 /*<---------------------BIG HEX INT CLASS---------------------->*/
+class MontgomeryContext;
+class BarrettContext;
+
+// Top-level algorithm for BigHexInt::multiply; recursive sub-products always use Automatic
+enum class MultiplyAlgorithm {
+    Automatic,    // schoolbook, Karatsuba, Toom-3 or NTT by operand size
+    Schoolbook,
+    Karatsuba,
+    Toom3,
+    Ntt           // falls back to Automatic beyond NTT_MAX_LIMBS
+};
+
+// Reduction used inside BigHexInt::modPow
+enum class ModularReducer {
+    Automatic,    // Montgomery for odd moduli, Barrett otherwise
+    Division,     // plain multiply and %
+    Montgomery,   // odd moduli only
+    Barrett
+};
+
+// Magnitude is stored as 64-bit limbs, least significant limb first.
+// Hex text is only produced by toString()/print() and parsed by createFromString().
+// shiftLeft/getLower/getHigher/pad take their counts in limbs.
+// Up to INLINE_LIMBS limbs live inside the object, larger values spill to the heap.
 class BigHexInt {
 public:
-    char digits[MAX_HEX_RESULT_SIZE];
-    int length;
+    Limb* limbs;         // points at inlineLimbs or at heap storage
+    int length;          // limbs in use, always >= 1
+    int capacity;
     bool isNegative;
 
     BigHexInt();
     BigHexInt(const std::string& str);
+    BigHexInt(const BigHexInt& other);
+    BigHexInt(BigHexInt&& other) noexcept;
+    BigHexInt& operator=(const BigHexInt& other);
+    BigHexInt& operator=(BigHexInt&& other) noexcept;
+    ~BigHexInt();
 
     static BigHexInt createFromString(const std::string& str);
     BigHexInt operator+(const BigHexInt& other) const;
     BigHexInt operator-(const BigHexInt& other) const;
     BigHexInt operator*(const BigHexInt& other) const;
+    BigHexInt square() const;
+    BigHexInt multiply(const BigHexInt& other, MultiplyAlgorithm algorithm) const;
+    // Short products of the magnitudes, n in limbs (B = 2^64): mulLow is
+    // (this * other) mod B^n, mulHigh is floor(this * other / B^n) or slightly less
+    // (see mulHighLimbs) and needs both operands below B^n
+    BigHexInt mulLow(const BigHexInt& other, int n) const;
+    BigHexInt mulHigh(const BigHexInt& other, int n) const;
     BigHexInt operator/(const BigHexInt& other) const;
     BigHexInt operator%(const BigHexInt& other) const;
+
+    // In-place forms reuse this object's storage; shifts count bits
+    BigHexInt& operator+=(const BigHexInt& other);
+    BigHexInt& operator-=(const BigHexInt& other);
+    BigHexInt& operator*=(const BigHexInt& other);
+    BigHexInt& operator%=(const BigHexInt& other);
+    BigHexInt& operator<<=(int bits);
+    BigHexInt& operator>>=(int bits);
+
+    // Bitwise operators see negative values as infinite two's complement (as in GMP),
+    // so ~x == -x - 1. All of them run limb by limb. The bit shifts are the exception:
+    // like their in-place forms they move the magnitude and keep the sign, so >> truncates
+    // toward zero and x >> k != floor(x / 2^k) for negative x (-5 >> 1 == -2, not -3).
+    // Mask or sample negative values with & instead.
+    BigHexInt operator&(const BigHexInt& other) const;
+    BigHexInt operator|(const BigHexInt& other) const;
+    BigHexInt operator^(const BigHexInt& other) const;
+    BigHexInt operator~() const;
+    BigHexInt operator<<(int bits) const;
+    BigHexInt operator>>(int bits) const;
+    BigHexInt& operator&=(const BigHexInt& other);
+    BigHexInt& operator|=(const BigHexInt& other);
+    BigHexInt& operator^=(const BigHexInt& other);
+    // Bit queries on the magnitude: bits up to the highest set one (0 for zero),
+    // bit index counted from the least significant, number of set bits
+    int bitLength() const;
+    bool testBit(int index) const;
+    int popcount() const;
     
     int compare(const BigHexInt& other) const;
     void print() const;
@@ -92,14 +180,195 @@ public:
     bool isOne() const;
     bool isGreaterOrEqual(const BigHexInt& other) const;
     std::string toString() const;
-    BigHexInt modPow(const BigHexInt& exponent, const BigHexInt& modulus) const;
+    BigHexInt modPow(const BigHexInt& exponent, const BigHexInt& modulus,
+                     ModularReducer reducer = ModularReducer::Automatic) const;
+    BigHexInt modPow(const BigHexInt& exponent, const MontgomeryContext& context) const;
+    BigHexInt modPow(const BigHexInt& exponent, const BarrettContext& context) const;
+
+    // Storage management
+    void reserve(int n);
+    void resize(int n);
 
 private:
+    friend class MontgomeryContext;
+    friend class BarrettContext;
+
+    Limb inlineLimbs[INLINE_LIMBS];
+
+    enum class BitwiseOp { And, Or, Xor };
+
     bool isOdd() const;
-    BigHexInt divideByTwo() const;
+    void trim();
+    void accumulate(const BigHexInt& other, bool otherNegative);
+    void bitwiseInPlace(const BigHexInt& other, BitwiseOp op);
     BigHexInt multiplyNaive(const BigHexInt& other) const;
-    BigHexInt karatsuba(const BigHexInt& other) const;
+    BigHexInt multiplyNtt(const BigHexInt& other) const;
+    BigHexInt multiplyMagnitude(const BigHexInt& other) const;
+    BigHexInt multiplyUnbalanced(const BigHexInt& shorter, int longLen, int shortLen) const;
+    BigHexInt karatsubaSplit(const BigHexInt& other) const;
+    BigHexInt toom3(const BigHexInt& other) const;
+    Limb divideSmallInPlace(Limb divisor);
+    BigHexInt karatsubaSquare() const;
     BigHexInt divide(const BigHexInt& divisor, BigHexInt* remainder = nullptr) const;
 };
 
 
+/*<---------------------FIXED WIDTH BIG INT---------------------->*/
+// Unsigned integer with a compile-time limb count for the DH sizes we deploy.
+// No length bookkeeping: every loop runs over exactly LIMBS limbs so the
+// compiler can unroll and inline it. Addition/subtraction wrap modulo 2^Bits,
+// operator* returns the full double-width product. There is no reduction or modPow:
+// this is a building block only, and modPow and millerRabinTest run on BigHexInt.
+template <int Bits>
+class FixedBigInt {
+    static_assert(Bits > 0 && Bits % LIMB_BITS == 0, "FixedBigInt width must be a multiple of 64 bits");
+
+public:
+    static constexpr int LIMBS = Bits / LIMB_BITS;
+    Limb limbs[LIMBS];
+
+    FixedBigInt();
+    explicit FixedBigInt(const BigHexInt& value);
+
+    static FixedBigInt createFromString(const std::string& str);
+    BigHexInt toBigHexInt() const;
+    std::string toString() const;
+
+    Limb addInPlace(const FixedBigInt& other);   // returns the carry out
+    Limb subInPlace(const FixedBigInt& other);   // returns the borrow out
+    FixedBigInt operator+(const FixedBigInt& other) const;
+    FixedBigInt operator-(const FixedBigInt& other) const;
+    FixedBigInt<2 * Bits> operator*(const FixedBigInt& other) const;
+
+    int compare(const FixedBigInt& other) const;
+    bool isZero() const;
+    bool isOdd() const;
+};
+
+typedef FixedBigInt<1024> FixedBigInt1024;
+typedef FixedBigInt<2048> FixedBigInt2048;
+typedef FixedBigInt<3072> FixedBigInt3072;
+typedef FixedBigInt<4096> FixedBigInt4096;
+
+template <int Bits>
+inline FixedBigInt<Bits>::FixedBigInt() {
+    for (int i = 0; i < LIMBS; i++) {
+        limbs[i] = 0;
+    }
+}
+
+template <int Bits>
+inline FixedBigInt<Bits>::FixedBigInt(const BigHexInt& value) : FixedBigInt() {
+    if (value.isNegative) {
+        throw InvalidInputException("negative value for FixedBigInt<" + std::to_string(Bits) + ">");
+    }
+    int used = value.length;
+    while (used > 1 && value.limbs[used - 1] == 0) {
+        used--;
+    }
+    if (used > LIMBS) {
+        throw OverflowException("FixedBigInt<" + std::to_string(Bits) + "> conversion");
+    }
+    for (int i = 0; i < used; i++) {
+        limbs[i] = value.limbs[i];
+    }
+}
+
+template <int Bits>
+inline FixedBigInt<Bits> FixedBigInt<Bits>::createFromString(const std::string& str) {
+    return FixedBigInt(BigHexInt::createFromString(str));
+}
+
+template <int Bits>
+inline BigHexInt FixedBigInt<Bits>::toBigHexInt() const {
+    int used = LIMBS;
+    while (used > 1 && limbs[used - 1] == 0) {
+        used--;
+    }
+    BigHexInt result;
+    result.resize(used);
+    for (int i = 0; i < used; i++) {
+        result.limbs[i] = limbs[i];
+    }
+    return result;
+}
+
+template <int Bits>
+inline std::string FixedBigInt<Bits>::toString() const {
+    return toBigHexInt().toString();
+}
+
+template <int Bits>
+inline Limb FixedBigInt<Bits>::addInPlace(const FixedBigInt& other) {
+    Limb carry = 0;
+    for (int i = 0; i < LIMBS; i++) {
+        DoubleLimb sum = (DoubleLimb)limbs[i] + other.limbs[i] + carry;
+        limbs[i] = (Limb)sum;
+        carry = (Limb)(sum >> LIMB_BITS);
+    }
+    return carry;
+}
+
+template <int Bits>
+inline Limb FixedBigInt<Bits>::subInPlace(const FixedBigInt& other) {
+    Limb borrow = 0;
+    for (int i = 0; i < LIMBS; i++) {
+        DoubleLimb diff = (DoubleLimb)limbs[i] - other.limbs[i] - borrow;
+        limbs[i] = (Limb)diff;
+        borrow = (Limb)(diff >> LIMB_BITS) & 1;
+    }
+    return borrow;
+}
+
+template <int Bits>
+inline FixedBigInt<Bits> FixedBigInt<Bits>::operator+(const FixedBigInt& other) const {
+    FixedBigInt result = *this;
+    result.addInPlace(other);
+    return result;
+}
+
+template <int Bits>
+inline FixedBigInt<Bits> FixedBigInt<Bits>::operator-(const FixedBigInt& other) const {
+    FixedBigInt result = *this;
+    result.subInPlace(other);
+    return result;
+}
+
+template <int Bits>
+inline FixedBigInt<2 * Bits> FixedBigInt<Bits>::operator*(const FixedBigInt& other) const {
+    FixedBigInt<2 * Bits> result;
+    for (int i = 0; i < LIMBS; i++) {
+        Limb carry = 0;
+        for (int j = 0; j < LIMBS; j++) {
+            DoubleLimb cur = (DoubleLimb)limbs[i] * other.limbs[j] + result.limbs[i + j] + carry;
+            result.limbs[i + j] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        result.limbs[i + LIMBS] = carry;
+    }
+    return result;
+}
+
+template <int Bits>
+inline int FixedBigInt<Bits>::compare(const FixedBigInt& other) const {
+    for (int i = LIMBS - 1; i >= 0; i--) {
+        if (limbs[i] != other.limbs[i]) {
+            return (limbs[i] > other.limbs[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+template <int Bits>
+inline bool FixedBigInt<Bits>::isZero() const {
+    Limb bits = 0;
+    for (int i = 0; i < LIMBS; i++) {
+        bits |= limbs[i];
+    }
+    return bits == 0;
+}
+
+template <int Bits>
+inline bool FixedBigInt<Bits>::isOdd() const {
+    return (limbs[0] & 1) == 1;
+}
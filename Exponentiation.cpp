@@ -0,0 +1,29 @@
+#include "Exponentiation.hpp"
+
+ExponentBitIterator::ExponentBitIterator(const BigHexInt& exponent)
+    : limbs(exponent.limbs), bits(exponent.bitLength()) {}
+
+int ExponentBitIterator::length() const {
+    return bits;
+}
+
+bool ExponentBitIterator::test(int index) const {
+    return (limbs[index / LIMB_BITS] >> (index % LIMB_BITS)) & 1;
+}
+
+unsigned ExponentBitIterator::window(int high, int low) const {
+    unsigned value = 0;
+    for (int i = high; i >= low; i--) {
+        value = (value << 1) | (test(i) ? 1u : 0u);
+    }
+    return value;
+}
+
+// Thresholds balance the 2^(width-1) table entries against the multiplications they save
+int slidingWindowWidth(int exponentBits) {
+    if (exponentBits > 671) return 6;
+    if (exponentBits > 239) return 5;
+    if (exponentBits > 79) return 4;
+    if (exponentBits > 23) return 3;
+    return 1;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+#include <vector>
+
+// Random access to the bits of a non-negative exponent straight from its limbs,
+// so exponentiation loops never shift or copy the exponent
+class ExponentBitIterator {
+public:
+    explicit ExponentBitIterator(const BigHexInt& exponent);
+
+    // Index of the highest set bit plus one, 0 for a zero exponent
+    int length() const;
+    bool test(int index) const;
+    // Bits high down to low (inclusive) as an integer, at most 32 bits wide
+    unsigned window(int high, int low) const;
+
+private:
+    const Limb* limbs;
+    int bits;
+};
+
+// Sliding window width for an exponent of the given bit length
+int slidingWindowWidth(int exponentBits);
+
+// Left-to-right sliding window exponentiation over any element type.
+// multiply(out, a, b) must accept out aliasing a or b. Odd powers base^1,
+// base^3, ..., base^(2^width - 1) are precomputed, then every run of zero bits
+// costs only squarings and every window of up to width bits one multiplication.
+template <typename T, typename Multiply>
+T windowedPow(const T& base, const T& one, const BigHexInt& exponent, Multiply multiply, int width = 0) {
+    ExponentBitIterator bits(exponent);
+    if (bits.length() == 0) {
+        return one;
+    }
+    if (width <= 0) {
+        width = slidingWindowWidth(bits.length());
+    }
+
+    std::vector<T> oddPowers(1, base);
+    if (width > 1) {
+        T square = base;
+        multiply(square, base, base);
+        oddPowers.resize((size_t)1 << (width - 1), base);
+        for (size_t i = 1; i < oddPowers.size(); i++) {
+            multiply(oddPowers[i], oddPowers[i - 1], square);
+        }
+    }
+
+    T result = one;
+    bool started = false;
+    int i = bits.length() - 1;
+    while (i >= 0) {
+        if (!bits.test(i)) {
+            multiply(result, result, result);
+            i--;
+            continue;
+        }
+        // Longest window of at most width bits that starts at i and ends on a set bit
+        int low = std::max(i - width + 1, 0);
+        while (!bits.test(low)) {
+            low++;
+        }
+        unsigned value = bits.window(i, low);
+        if (started) {
+            for (int s = i; s >= low; s--) {
+                multiply(result, result, result);
+            }
+            multiply(result, result, oddPowers[value >> 1]);
+        } else {
+            // Squaring the initial one would be wasted work
+            result = oddPowers[value >> 1];
+            started = true;
+        }
+        i = low - 1;
+    }
+    return result;
+}
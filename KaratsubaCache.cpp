@@ -0,0 +1,252 @@
+#include "KaratsubaCache.hpp"
+
+KaratsubaCache karatsubaCache;
+
+// Number of limbs without leading zero limbs (padded operands share a key)
+static int significantLength(const BigHexInt& value) {
+    int len = value.length;
+    while (len > 1 && value.limbs[len - 1] == 0) {
+        len--;
+    }
+    return len;
+}
+
+KaratsubaCache::KaratsubaCache(size_t maxEntries, size_t memoryBudget)
+    : maxEntries(maxEntries), memoryBudget(memoryBudget), bytesUsed(0), entryCount(0),
+      hand(0), enabled(true), hitCount(0), missCount(0), evictionCount(0) {
+    slots.reserve(maxEntries);
+    index.reserve(maxEntries);
+}
+
+// Orders the operands larger magnitude first and drops their leading zero limbs
+void KaratsubaCache::canonicalOperands(const BigHexInt& a, const BigHexInt& b,
+                                       const Limb*& x, int& xLen, const Limb*& y, int& yLen) {
+    const BigHexInt* first = &a;
+    const BigHexInt* second = &b;
+    if (!first->isGreaterOrEqual(*second)) {
+        std::swap(first, second);
+    }
+    x = first->limbs;
+    xLen = significantLength(*first);
+    y = second->limbs;
+    yLen = significantLength(*second);
+}
+
+uint64_t KaratsubaCache::hashOperands(const Limb* a, int aLen, const Limb* b, int bLen) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ ((uint64_t)aLen << 32) ^ (uint64_t)bLen;
+    auto mix = [&h](Limb limb) {
+        h ^= limb;
+        h *= 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    };
+    for (int i = 0; i < aLen; i++) mix(a[i]);
+    for (int i = 0; i < bLen; i++) mix(b[i]);
+    return h;
+}
+
+size_t KaratsubaCache::slotBytes(const Slot& slot) {
+    // Limb payload plus a rough allowance for the slot and its index node
+    return slot.limbs.capacity() * sizeof(Limb) + sizeof(Slot) + 32;
+}
+
+bool KaratsubaCache::matches(const Slot& slot, const Limb* a, int aLen, const Limb* b, int bLen) const {
+    if (slot.aLength != aLen || slot.bLength != bLen) {
+        return false;
+    }
+    return std::equal(a, a + aLen, slot.limbs.begin()) &&
+           std::equal(b, b + bLen, slot.limbs.begin() + aLen);
+}
+
+bool KaratsubaCache::lookup(const BigHexInt& a, const BigHexInt& b, BigHexInt& product) {
+    if (!enabled) {
+        return false;
+    }
+    const Limb* x;
+    const Limb* y;
+    int xLen, yLen;
+    canonicalOperands(a, b, x, xLen, y, yLen);
+
+    auto it = index.find(hashOperands(x, xLen, y, yLen));
+    if (it == index.end() || !matches(slots[it->second], x, xLen, y, yLen)) {
+        missCount++;
+        return false;
+    }
+
+    Slot& slot = slots[it->second];
+    slot.referenced = true;
+    product.resize(slot.productLength);
+    std::copy(slot.limbs.begin() + slot.aLength + slot.bLength, slot.limbs.end(), product.limbs);
+    product.isNegative = false;
+    hitCount++;
+    return true;
+}
+
+void KaratsubaCache::insert(const BigHexInt& a, const BigHexInt& b, const BigHexInt& product) {
+    if (!enabled) {
+        return;
+    }
+    const Limb* x;
+    const Limb* y;
+    int xLen, yLen;
+    canonicalOperands(a, b, x, xLen, y, yLen);
+    int pLen = significantLength(product);
+    uint64_t hash = hashOperands(x, xLen, y, yLen);
+
+    size_t payload = (size_t)(xLen + yLen + pLen);
+    size_t needed = payload * sizeof(Limb) + sizeof(Slot) + 32;
+    if (needed > memoryBudget) {
+        return;
+    }
+
+    // A colliding or repeated key gives up its old entry first, so it is never a victim
+    // and the new payload is held to the budget like any other insertion
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        release(it->second);
+    }
+    while (entryCount > 0 && bytesUsed + needed > memoryBudget) {
+        evict(nextVictim());
+    }
+    int slotIndex = acquireSlot();
+    index[hash] = slotIndex;
+    entryCount++;
+
+    Slot& slot = slots[slotIndex];
+    slot.hash = hash;
+    slot.aLength = xLen;
+    slot.bLength = yLen;
+    slot.productLength = pLen;
+    slot.limbs.assign(x, x + xLen);
+    slot.limbs.insert(slot.limbs.end(), y, y + yLen);
+    slot.limbs.insert(slot.limbs.end(), product.limbs, product.limbs + pLen);
+    slot.limbs.shrink_to_fit();
+    slot.occupied = true;
+    slot.referenced = false;
+    bytesUsed += slotBytes(slot);
+}
+
+// Returns an empty slot, evicting one when every slot is in use
+int KaratsubaCache::acquireSlot() {
+    if (!freeSlots.empty()) {
+        int slotIndex = freeSlots.back();
+        freeSlots.pop_back();
+        return slotIndex;
+    }
+    if (slots.size() < maxEntries) {
+        slots.emplace_back();
+        return (int)slots.size() - 1;
+    }
+    int victim = nextVictim();
+    evict(victim);
+    freeSlots.pop_back();
+    return victim;
+}
+
+// CLOCK sweep: referenced entries get a second chance, the first unreferenced one goes
+int KaratsubaCache::nextVictim() {
+    while (true) {
+        if (hand >= slots.size()) {
+            hand = 0;
+        }
+        Slot& slot = slots[hand];
+        int current = (int)hand;
+        hand++;
+        if (!slot.occupied) {
+            continue;
+        }
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        return current;
+    }
+}
+
+void KaratsubaCache::evict(int slotIndex) {
+    release(slotIndex);
+    evictionCount++;
+}
+
+// Frees a slot without counting it as an eviction
+void KaratsubaCache::release(int slotIndex) {
+    Slot& slot = slots[slotIndex];
+    index.erase(slot.hash);
+    bytesUsed -= slotBytes(slot);
+    slot.limbs.clear();
+    slot.limbs.shrink_to_fit();
+    slot.occupied = false;
+    slot.referenced = false;
+    freeSlots.push_back(slotIndex);
+    entryCount--;
+}
+
+void KaratsubaCache::forEach(const std::function<void(const BigHexInt&, const BigHexInt&, const BigHexInt&)>& visit) const {
+    BigHexInt a, b, product;
+    for (const Slot& slot : slots) {
+        if (!slot.occupied) {
+            continue;
+        }
+        const Limb* data = slot.limbs.data();
+        a.resize(slot.aLength);
+        std::copy(data, data + slot.aLength, a.limbs);
+        b.resize(slot.bLength);
+        std::copy(data + slot.aLength, data + slot.aLength + slot.bLength, b.limbs);
+        product.resize(slot.productLength);
+        std::copy(data + slot.aLength + slot.bLength, data + slot.limbs.size(), product.limbs);
+        visit(a, b, product);
+    }
+}
+
+void KaratsubaCache::clear() {
+    slots.clear();
+    freeSlots.clear();
+    index.clear();
+    bytesUsed = 0;
+    entryCount = 0;
+    hand = 0;
+}
+
+void KaratsubaCache::setEnabled(bool on) {
+    enabled = on;
+}
+
+bool KaratsubaCache::isEnabled() const {
+    return enabled;
+}
+
+void KaratsubaCache::setMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+    while (entryCount > 0 && bytesUsed > memoryBudget) {
+        evict(nextVictim());
+    }
+}
+
+size_t KaratsubaCache::getMemoryBudget() const {
+    return memoryBudget;
+}
+
+size_t KaratsubaCache::size() const {
+    return entryCount;
+}
+
+size_t KaratsubaCache::memoryUsed() const {
+    return bytesUsed;
+}
+
+uint64_t KaratsubaCache::hits() const {
+    return hitCount;
+}
+
+uint64_t KaratsubaCache::misses() const {
+    return missCount;
+}
+
+uint64_t KaratsubaCache::evictions() const {
+    return evictionCount;
+}
+
+void KaratsubaCache::printStats() const {
+    std::cout << "Karatsuba cache: " << entryCount << " entries, " << bytesUsed << " / " << memoryBudget
+              << " bytes, " << hitCount << " hits, " << missCount << " misses, "
+              << evictionCount << " evictions" << std::endl;
+}
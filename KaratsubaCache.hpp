@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+constexpr size_t KARATSUBA_CACHE_MAX_ENTRIES = 1 << 16;
+constexpr size_t KARATSUBA_CACHE_MEMORY_BUDGET = 32 * 1024 * 1024;
+
+// Bounded memo for Karatsuba sub-products, keyed on the operand limbs.
+// Operands are stored in a canonical order (larger magnitude first) so a*b and
+// b*a share one entry. Entries sit in a fixed ring of slots indexed by a 64-bit
+// hash and are evicted with the CLOCK (second chance) policy whenever the slot
+// count or the memory budget would be exceeded.
+class KaratsubaCache {
+public:
+    KaratsubaCache(size_t maxEntries = KARATSUBA_CACHE_MAX_ENTRIES,
+                   size_t memoryBudget = KARATSUBA_CACHE_MEMORY_BUDGET);
+
+    bool lookup(const BigHexInt& a, const BigHexInt& b, BigHexInt& product);
+    void insert(const BigHexInt& a, const BigHexInt& b, const BigHexInt& product);
+    void forEach(const std::function<void(const BigHexInt&, const BigHexInt&, const BigHexInt&)>& visit) const;
+    void clear();
+
+    // Runtime switch: a disabled cache answers every lookup with a miss and stores nothing
+    void setEnabled(bool on);
+    bool isEnabled() const;
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+
+    size_t size() const;
+    size_t memoryUsed() const;
+    uint64_t hits() const;
+    uint64_t misses() const;
+    uint64_t evictions() const;
+    void printStats() const;
+
+    // Key helpers shared with the on-disk store. The hash is persisted, so it must stay stable.
+    static void canonicalOperands(const BigHexInt& a, const BigHexInt& b,
+                                  const Limb*& x, int& xLen, const Limb*& y, int& yLen);
+    static uint64_t hashOperands(const Limb* a, int aLen, const Limb* b, int bLen);
+
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        int aLength = 0;
+        int bLength = 0;
+        int productLength = 0;
+        std::vector<Limb> limbs;     // a, b and the product back to back
+        bool occupied = false;
+        bool referenced = false;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    std::unordered_map<uint64_t, int> index;
+    size_t maxEntries;
+    size_t memoryBudget;
+    size_t bytesUsed;
+    size_t entryCount;
+    size_t hand;
+    bool enabled;
+    uint64_t hitCount;
+    uint64_t missCount;
+    uint64_t evictionCount;
+
+    static size_t slotBytes(const Slot& slot);
+    bool matches(const Slot& slot, const Limb* a, int aLen, const Limb* b, int bLen) const;
+    int acquireSlot();
+    void evict(int slotIndex);
+    void release(int slotIndex);
+    int nextVictim();
+};
+
+// Global memoization cache for Karatsuba multiplication
+extern KaratsubaCache karatsubaCache;
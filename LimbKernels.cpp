@@ -0,0 +1,625 @@
+#include "LimbKernels.hpp"
+#include "LimbKernelsX86.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+static int compareLimbsPortable(const Limb* a, int aLen, const Limb* b, int bLen) {
+    while (aLen > 1 && a[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && b[bLen - 1] == 0) bLen--;
+    if (aLen != bLen) {
+        return (aLen > bLen) ? 1 : -1;
+    }
+    for (int i = aLen - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+// result = a + b, requires aLen >= bLen, returns the carry out of limb aLen-1
+static Limb addLimbsPortable(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    Limb carry = 0;
+    for (int i = 0; i < bLen; i++) {
+        Limb sum = a[i] + carry;
+        carry = (sum < carry);
+        sum += b[i];
+        carry += (sum < b[i]);
+        result[i] = sum;
+    }
+    for (int i = bLen; i < aLen; i++) {
+        Limb sum = a[i] + carry;
+        carry = (sum < carry);
+        result[i] = sum;
+    }
+    return carry;
+}
+
+// result = a - b, requires a >= b and aLen >= bLen
+static void subLimbsPortable(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    Limb borrow = 0;
+    for (int i = 0; i < bLen; i++) {
+        Limb diff = a[i] - b[i];
+        Limb nextBorrow = (a[i] < b[i]);
+        nextBorrow += (diff < borrow);
+        result[i] = diff - borrow;
+        borrow = nextBorrow;
+    }
+    for (int i = bLen; i < aLen; i++) {
+        Limb diff = a[i] - borrow;
+        borrow = (a[i] < borrow);
+        result[i] = diff;
+    }
+}
+
+// Kernels in use; they start out portable so nothing can run before the CPU check
+static int (*compareImpl)(const Limb*, int, const Limb*, int) = compareLimbsPortable;
+static Limb (*addImpl)(Limb*, const Limb*, int, const Limb*, int) = addLimbsPortable;
+static void (*subImpl)(Limb*, const Limb*, int, const Limb*, int) = subLimbsPortable;
+static LimbKernelSet activeSet = LimbKernelSet::Portable;
+static const LimbKernelSet startupSet = selectLimbKernels(LimbKernelSet::Automatic);
+
+// Fastest first, as measured with benchmark_Limb_Kernels
+static LimbKernelSet bestLimbKernels() {
+    for (LimbKernelSet set : {LimbKernelSet::Avx512, LimbKernelSet::Avx2, LimbKernelSet::CarryChain}) {
+        if (limbKernelsSupported(set)) {
+            return set;
+        }
+    }
+    return LimbKernelSet::Portable;
+}
+
+bool limbKernelsSupported(LimbKernelSet set) {
+    switch (set) {
+        case LimbKernelSet::Automatic:
+        case LimbKernelSet::Portable:
+            return true;
+#if defined(LIMB_KERNELS_X86)
+        case LimbKernelSet::CarryChain:
+            return true;
+        case LimbKernelSet::Avx2:
+            return cpuSupportsAvx2();
+        case LimbKernelSet::Avx512:
+            return cpuSupportsAvx512();
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* limbKernelSetName(LimbKernelSet set) {
+    switch (set) {
+        case LimbKernelSet::Automatic: return "automatic";
+        case LimbKernelSet::Portable: return "portable";
+        case LimbKernelSet::CarryChain: return "carry chain";
+        case LimbKernelSet::Avx2: return "AVX2";
+        case LimbKernelSet::Avx512: return "AVX-512";
+    }
+    return "unknown";
+}
+
+LimbKernelSet selectLimbKernels(LimbKernelSet set) {
+    if (set == LimbKernelSet::Automatic) {
+        set = bestLimbKernels();
+    } else if (!limbKernelsSupported(set)) {
+        set = LimbKernelSet::Portable;
+    }
+
+    compareImpl = compareLimbsPortable;
+    addImpl = addLimbsPortable;
+    subImpl = subLimbsPortable;
+#if defined(LIMB_KERNELS_X86)
+    if (set == LimbKernelSet::CarryChain) {
+        addImpl = addLimbsCarryChain;
+        subImpl = subLimbsCarryChain;
+    } else if (set == LimbKernelSet::Avx2) {
+        compareImpl = compareLimbsAvx2;
+        addImpl = addLimbsAvx2;
+        subImpl = subLimbsAvx2;
+    } else if (set == LimbKernelSet::Avx512) {
+        compareImpl = compareLimbsAvx512;
+        addImpl = addLimbsAvx512;
+        subImpl = subLimbsAvx512;
+    }
+#endif
+    activeSet = set;
+    return set;
+}
+
+LimbKernelSet activeLimbKernels() {
+    return activeSet;
+}
+
+int compareLimbs(const Limb* a, int aLen, const Limb* b, int bLen) {
+    return compareImpl(a, aLen, b, bLen);
+}
+
+Limb addLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    return addImpl(result, a, aLen, b, bLen);
+}
+
+void subLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    subImpl(result, a, aLen, b, bLen);
+}
+
+// Comba (product scanning) kernels for fixed sizes. Column k of the product sums
+// every a[i] * b[k - i] into a three-limb accumulator before anything is stored, so
+// each result limb is written once. The sizes are template arguments and the
+// columns are expanded with fold expressions, which leaves straight-line code with
+// no loop counters or branches.
+struct CombaAccumulator {
+    DoubleLimb low = 0;
+    Limb high = 0;
+
+    __attribute__((always_inline)) void add(DoubleLimb product) {
+        low += product;
+        high += (low < product);
+    }
+    __attribute__((always_inline)) void add(const CombaAccumulator& other) {
+        low += other.low;
+        high += other.high + (low < other.low);
+    }
+    __attribute__((always_inline)) void doubleInPlace() {
+        high = (high << 1) | (Limb)(low >> (2 * LIMB_BITS - 1));
+        low <<= 1;
+    }
+    // Returns the finished column limb and moves the rest down one limb
+    __attribute__((always_inline)) Limb shift() {
+        Limb out = (Limb)low;
+        low = (low >> LIMB_BITS) | ((DoubleLimb)high << LIMB_BITS);
+        high = 0;
+        return out;
+    }
+};
+
+template <int N, int K>
+struct CombaColumn {
+    static constexpr int first = (K < N) ? 0 : K - N + 1;
+    static constexpr int count = ((K < N) ? K : N - 1) - first + 1;
+    // Cross products a[i] * a[K - i] with i < K - i, for squaring
+    static constexpr int lastCross = (K - 1) / 2;
+    static constexpr int crossCount = (K > 0 && lastCross >= first) ? lastCross - first + 1 : 0;
+
+    template <int... I>
+    __attribute__((always_inline)) static void multiply(CombaAccumulator& acc, const Limb* a, const Limb* b,
+                                                        std::integer_sequence<int, I...>) {
+        (acc.add((DoubleLimb)a[first + I] * b[K - first - I]), ...);
+    }
+
+    template <int... I>
+    __attribute__((always_inline)) static void square(CombaAccumulator& acc, const Limb* a,
+                                                      std::integer_sequence<int, I...>) {
+        CombaAccumulator cross;
+        (cross.add((DoubleLimb)a[first + I] * a[K - first - I]), ...);
+        cross.doubleInPlace();
+        acc.add(cross);
+        if (K % 2 == 0) {
+            acc.add((DoubleLimb)a[K / 2] * a[K / 2]);
+        }
+    }
+};
+
+template <int N, int... K>
+static void combaMul(Limb* result, const Limb* a, const Limb* b, std::integer_sequence<int, K...>) {
+    CombaAccumulator acc;
+    ((CombaColumn<N, K>::multiply(acc, a, b, std::make_integer_sequence<int, CombaColumn<N, K>::count>()),
+      result[K] = acc.shift()), ...);
+    result[2 * N - 1] = (Limb)acc.low;
+}
+
+template <int N, int... K>
+static void combaSqr(Limb* result, const Limb* a, std::integer_sequence<int, K...>) {
+    CombaAccumulator acc;
+    ((CombaColumn<N, K>::square(acc, a, std::make_integer_sequence<int, CombaColumn<N, K>::crossCount>()),
+      result[K] = acc.shift()), ...);
+    result[2 * N - 1] = (Limb)acc.low;
+}
+
+template <int N>
+static void combaMul(Limb* result, const Limb* a, const Limb* b) {
+    combaMul<N>(result, a, b, std::make_integer_sequence<int, 2 * N - 1>());
+}
+
+template <int N>
+static void combaSqr(Limb* result, const Limb* a) {
+    combaSqr<N>(result, a, std::make_integer_sequence<int, 2 * N - 1>());
+}
+
+// Jumps to the unrolled kernel for n limbs; false if there is none for that size
+static bool combaMulFixed(Limb* result, const Limb* a, const Limb* b, int n) {
+    switch (n) {
+        case 1: combaMul<1>(result, a, b); return true;
+        case 2: combaMul<2>(result, a, b); return true;
+        case 4: combaMul<4>(result, a, b); return true;
+        case 8: combaMul<8>(result, a, b); return true;
+        case 16: combaMul<16>(result, a, b); return true;
+        case 32: combaMul<32>(result, a, b); return true;
+        default: return false;
+    }
+}
+
+static bool combaSqrFixed(Limb* result, const Limb* a, int n) {
+    switch (n) {
+        case 1: combaSqr<1>(result, a); return true;
+        case 2: combaSqr<2>(result, a); return true;
+        case 4: combaSqr<4>(result, a); return true;
+        case 8: combaSqr<8>(result, a); return true;
+        case 16: combaSqr<16>(result, a); return true;
+        case 32: combaSqr<32>(result, a); return true;
+        default: return false;
+    }
+}
+
+// result[0 .. aLen+bLen) = a * b, result must not alias the inputs
+void mulLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    if (aLen == bLen && combaMulFixed(result, a, b, aLen)) {
+        return;
+    }
+    std::fill(result, result + aLen + bLen, 0);
+    for (int i = 0; i < aLen; i++) {
+        Limb carry = 0;
+        for (int j = 0; j < bLen; j++) {
+            DoubleLimb cur = (DoubleLimb)a[i] * b[j] + result[i + j] + carry;
+            result[i + j] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        result[i + bLen] = carry;
+    }
+}
+
+// result[0 .. 2*aLen) = a * a: sum the products a[i] * a[j] with i < j once,
+// double them with a one-bit shift and add the squares a[i]^2 on the diagonal
+void sqrLimbs(Limb* result, const Limb* a, int aLen) {
+    if (combaSqrFixed(result, a, aLen)) {
+        return;
+    }
+    std::fill(result, result + 2 * aLen, 0);
+    for (int i = 0; i < aLen; i++) {
+        Limb carry = 0;
+        for (int j = i + 1; j < aLen; j++) {
+            DoubleLimb cur = (DoubleLimb)a[i] * a[j] + result[i + j] + carry;
+            result[i + j] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        result[i + aLen] = carry;
+    }
+
+    Limb topBit = 0;
+    for (int k = 0; k < 2 * aLen; k++) {
+        Limb value = result[k];
+        result[k] = (value << 1) | topBit;
+        topBit = value >> (LIMB_BITS - 1);
+    }
+
+    Limb carry = 0;
+    for (int i = 0; i < aLen; i++) {
+        DoubleLimb square = (DoubleLimb)a[i] * a[i];
+        DoubleLimb low = (DoubleLimb)result[2 * i] + (Limb)square + carry;
+        result[2 * i] = (Limb)low;
+        DoubleLimb high = (DoubleLimb)result[2 * i + 1] + (Limb)(square >> LIMB_BITS) + (Limb)(low >> LIMB_BITS);
+        result[2 * i + 1] = (Limb)high;
+        carry = (Limb)(high >> LIMB_BITS);
+    }
+}
+
+// out[0 .. h) = |x - y| for x of xLen <= h limbs and y of h limbs; returns whether x < y
+static bool absDiffLimbs(Limb* out, const Limb* x, int xLen, const Limb* y, int h) {
+    if (compareLimbs(x, xLen, y, h) < 0) {
+        subLimbs(out, y, h, x, xLen);
+        return true;
+    }
+    // y <= x < B^xLen, so the limbs of y above xLen are zero
+    subLimbs(out, x, xLen, y, xLen);
+    std::fill(out + xLen, out + h, 0);
+    return false;
+}
+
+// Adds z0 + z2 +/- t (the middle term) into result at limb m. result holds z0 in
+// [0, 2m) and z2 in [2m, 2n); mid needs 2h + 1 limbs.
+static void addMiddleTerm(Limb* result, int m, int h, const Limb* t, bool subtract, Limb* mid) {
+    const Limb* z0 = result;
+    const Limb* z2 = result + 2 * m;
+    mid[2 * h] = addLimbs(mid, z2, 2 * h, z0, 2 * m);
+    if (subtract) {
+        subLimbs(mid, mid, 2 * h + 1, t, 2 * h);
+    } else {
+        addLimbs(mid, mid, 2 * h + 1, t, 2 * h);
+    }
+    addLimbs(result + m, result + m, m + 2 * h, mid, 2 * h + 1);
+}
+
+static void karatsubaMulStep(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs,
+                             int parallelLimbs, Limb* scratch);
+static void karatsubaSqrStep(Limb* result, const Limb* a, int n, int baseLimbs, int parallelLimbs, Limb* scratch);
+
+static void karatsubaMulRecurse(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs,
+                                int parallelLimbs, Limb* scratch) {
+    if (n <= baseLimbs) {
+        mulLimbs(result, a, n, b, n);
+    } else {
+        karatsubaMulStep(result, a, b, n, baseLimbs, parallelLimbs, scratch);
+    }
+}
+
+static void karatsubaSqrRecurse(Limb* result, const Limb* a, int n, int baseLimbs, int parallelLimbs, Limb* scratch) {
+    if (n <= baseLimbs) {
+        sqrLimbs(result, a, n);
+    } else {
+        karatsubaSqrStep(result, a, n, baseLimbs, parallelLimbs, scratch);
+    }
+}
+
+// Scratch a sub-product of n limbs needs: none for a base case
+static int childScratchLimbs(int n, int baseLimbs) {
+    return (n <= baseLimbs) ? 0 : karatsubaScratchLimbs(n, baseLimbs);
+}
+
+// Whether a step of n limbs hands its sub-products to the thread pool
+static bool runsInParallel(int n, int parallelLimbs) {
+    return n >= parallelLimbs && threadPool.isParallel();
+}
+
+// Subtractive Karatsuba: with a = a1 * B^m + a0 and b likewise,
+// a0 * b1 + a1 * b0 = z0 + z2 + (a0 - a1)(b1 - b0), so the middle product runs on
+// h = n - m limbs with no carry limb and the recursion always shrinks.
+// Scratch layout: |a0 - a1| (h), |b1 - b0| (h), their product (2h), then the
+// sub-recursions' scratch, which is reused for the middle sum once they are done.
+// A parallel step writes z0, z2 and the middle product to disjoint places and gives
+// z0 and z2 scratch of their own, allocated once per step.
+static void karatsubaMulStep(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs,
+                             int parallelLimbs, Limb* scratch) {
+    int m = n / 2;
+    int h = n - m;
+    Limb* da = scratch;
+    Limb* db = scratch + h;
+    Limb* t = scratch + 2 * h;
+    Limb* rest = scratch + 4 * h;
+
+    bool aLess = absDiffLimbs(da, a, m, a + m, h);
+    bool bLess = absDiffLimbs(db, b, m, b + m, h);
+    if (runsInParallel(n, parallelLimbs)) {
+        int child = childScratchLimbs(h, baseLimbs);
+        std::vector<Limb> own(2 * (size_t)child);
+        threadPool.run({
+            [&]() { karatsubaMulRecurse(t, da, db, h, baseLimbs, parallelLimbs, rest); },
+            [&]() { karatsubaMulRecurse(result, a, b, m, baseLimbs, parallelLimbs, own.data()); },
+            [&]() { karatsubaMulRecurse(result + 2 * m, a + m, b + m, h, baseLimbs, parallelLimbs, own.data() + child); }
+        });
+    } else {
+        karatsubaMulRecurse(t, da, db, h, baseLimbs, parallelLimbs, rest);
+        karatsubaMulRecurse(result, a, b, m, baseLimbs, parallelLimbs, rest);
+        karatsubaMulRecurse(result + 2 * m, a + m, b + m, h, baseLimbs, parallelLimbs, rest);
+    }
+
+    // a0 < a1 makes the first factor negative, b0 < b1 makes the second one positive
+    addMiddleTerm(result, m, h, t, aLess == bLess, rest);
+}
+
+// 2 * a0 * a1 = z0 + z2 - (a0 - a1)^2
+static void karatsubaSqrStep(Limb* result, const Limb* a, int n, int baseLimbs, int parallelLimbs, Limb* scratch) {
+    int m = n / 2;
+    int h = n - m;
+    Limb* da = scratch;
+    Limb* t = scratch + 2 * h;
+    Limb* rest = scratch + 4 * h;
+
+    absDiffLimbs(da, a, m, a + m, h);
+    if (runsInParallel(n, parallelLimbs)) {
+        int child = childScratchLimbs(h, baseLimbs);
+        std::vector<Limb> own(2 * (size_t)child);
+        threadPool.run({
+            [&]() { karatsubaSqrRecurse(t, da, h, baseLimbs, parallelLimbs, rest); },
+            [&]() { karatsubaSqrRecurse(result, a, m, baseLimbs, parallelLimbs, own.data()); },
+            [&]() { karatsubaSqrRecurse(result + 2 * m, a + m, h, baseLimbs, parallelLimbs, own.data() + child); }
+        });
+    } else {
+        karatsubaSqrRecurse(t, da, h, baseLimbs, parallelLimbs, rest);
+        karatsubaSqrRecurse(result, a, m, baseLimbs, parallelLimbs, rest);
+        karatsubaSqrRecurse(result + 2 * m, a + m, h, baseLimbs, parallelLimbs, rest);
+    }
+    addMiddleTerm(result, m, h, t, true, rest);
+}
+
+void karatsubaMulLimbs(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs, int parallelLimbs, Limb* scratch) {
+    karatsubaMulStep(result, a, b, n, baseLimbs, parallelLimbs, scratch);
+}
+
+void karatsubaSqrLimbs(Limb* result, const Limb* a, int n, int baseLimbs, int parallelLimbs, Limb* scratch) {
+    karatsubaSqrStep(result, a, n, baseLimbs, parallelLimbs, scratch);
+}
+
+// Each step uses 4h limbs of its own plus the larger of its children's needs and the 2h + 1 limb middle sum
+int karatsubaScratchLimbs(int n, int baseLimbs) {
+    int h = n - n / 2;
+    int child = childScratchLimbs(h, baseLimbs);
+    return 4 * h + std::max(child, 2 * h + 1);
+}
+
+// Short products: the two l-limb cross terms of Mulders' split (l = 3n/10) are short
+// products themselves, and one full k = n - l limb product covers the rest of the half
+// that is kept. The full product uses Karatsuba above baseLimbs.
+static int shortSplitLimbs(int n) {
+    return std::max(1, 3 * n / 10);
+}
+
+static void shortFullProduct(Limb* result, const Limb* a, const Limb* b, int k, int baseLimbs, Limb* scratch) {
+    if (k <= baseLimbs || k < 2) {
+        mulLimbs(result, a, k, b, k);
+    } else {
+        karatsubaMulLimbs(result, a, b, k, baseLimbs, std::numeric_limits<int>::max(), scratch);
+    }
+}
+
+// Schoolbook: only the n(n+1)/2 limb products below column n
+static void mulLowSchoolbook(Limb* result, const Limb* a, const Limb* b, int n) {
+    std::fill(result, result + n, 0);
+    for (int i = 0; i < n; i++) {
+        Limb carry = 0;
+        for (int j = 0; j < n - i; j++) {
+            DoubleLimb cur = (DoubleLimb)a[i] * b[j] + result[i + j] + carry;
+            result[i + j] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+    }
+}
+
+// Schoolbook: columns n - 2 and up, accumulated in acc (n + 2 limbs) from column n - 2.
+// The columns left out add up to less than B^n, so the result is at most one too small.
+static void mulHighSchoolbook(Limb* result, const Limb* a, const Limb* b, int n, Limb* acc) {
+    std::fill(acc, acc + n + 2, 0);
+    for (int i = 0; i < n; i++) {
+        Limb carry = 0;
+        for (int j = std::max(0, n - 2 - i); j < n; j++) {
+            Limb* column = acc + (i + j - (n - 2));
+            DoubleLimb cur = (DoubleLimb)a[i] * b[j] + *column + carry;
+            *column = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        acc[i + 2] = carry;
+    }
+    std::copy(acc + 2, acc + n + 2, result);
+}
+
+// a * b mod B^n = a0 * b0 + B^k * (a1 * b0 + a0 * b1) mod B^n with a = a1 * B^k + a0
+void mulLowLimbs(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs, Limb* scratch) {
+    if (n <= baseLimbs) {
+        mulLowSchoolbook(result, a, b, n);
+        return;
+    }
+    int l = shortSplitLimbs(n);
+    int k = n - l;
+    Limb* product = scratch;
+    Limb* cross = scratch + 2 * k;
+    Limb* rest = cross + l;
+
+    shortFullProduct(product, a, b, k, baseLimbs, cross);
+    std::copy(product, product + n, result);
+    mulLowLimbs(cross, a + k, b, l, baseLimbs, rest);
+    addLimbs(result + k, result + k, l, cross, l);
+    mulLowLimbs(cross, a, b + k, l, baseLimbs, rest);
+    addLimbs(result + k, result + k, l, cross, l);
+}
+
+// With a = a1 * B^l + a0, a * b / B^n is a1 * b1 / B^(k-l) plus the cross terms
+// a1 * b0 / B^k and a0 * b1 / B^k, whose top l limbs of a1 (b1) give all but a
+// fraction; each dropped fraction is below one, so every level adds at most five to
+// the two errors of its children
+void mulHighLimbs(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs, Limb* scratch) {
+    if (n <= baseLimbs) {
+        mulHighSchoolbook(result, a, b, n, scratch);
+        return;
+    }
+    int l = shortSplitLimbs(n);
+    int k = n - l;
+    Limb* product = scratch;
+    Limb* cross = scratch + 2 * k;
+    Limb* rest = cross + l;
+
+    shortFullProduct(product, a + l, b + l, k, baseLimbs, cross);
+    std::copy(product + (k - l), product + 2 * k, result);
+    mulHighLimbs(cross, a + k, b, l, baseLimbs, rest);
+    addLimbs(result, result, n, cross, l);
+    mulHighLimbs(cross, b + k, a, l, baseLimbs, rest);
+    addLimbs(result, result, n, cross, l);
+}
+
+// The full product's 2k limbs, then its Karatsuba scratch or one cross term and the recursion's scratch
+int shortProductScratchLimbs(int n, int baseLimbs) {
+    if (n <= baseLimbs) {
+        return n + 2;
+    }
+    int l = shortSplitLimbs(n);
+    int k = n - l;
+    int full = (k <= baseLimbs || k < 2) ? 0 : karatsubaScratchLimbs(k, baseLimbs);
+    return 2 * k + std::max(full, l + shortProductScratchLimbs(l, baseLimbs));
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1): quotient[0 .. uLen-vLen] = u / v and
+// remainder[0 .. vLen) = u % v. Requires uLen >= vLen and v[vLen-1] != 0;
+// work must hold uLen + vLen + 1 limbs and nothing may alias.
+void divLimbs(Limb* quotient, Limb* remainder, const Limb* u, int uLen,
+              const Limb* v, int vLen, Limb* work) {
+    if (vLen == 1) {
+        // Short division by a single limb
+        DoubleLimb rem = 0;
+        for (int i = uLen - 1; i >= 0; i--) {
+            DoubleLimb cur = (rem << LIMB_BITS) | u[i];
+            quotient[i] = (Limb)(cur / v[0]);
+            rem = cur % v[0];
+        }
+        remainder[0] = (Limb)rem;
+        return;
+    }
+
+    // Normalize so the divisor's top bit is set, which keeps each estimate at most 2 too large
+    int shift = __builtin_clzll(v[vLen - 1]);
+    Limb* un = work;
+    Limb* vn = work + uLen + 1;
+    for (int i = vLen - 1; i > 0; i--) {
+        vn[i] = shift ? (v[i] << shift) | (v[i - 1] >> (LIMB_BITS - shift)) : v[i];
+    }
+    vn[0] = v[0] << shift;
+    un[uLen] = shift ? u[uLen - 1] >> (LIMB_BITS - shift) : 0;
+    for (int i = uLen - 1; i > 0; i--) {
+        un[i] = shift ? (u[i] << shift) | (u[i - 1] >> (LIMB_BITS - shift)) : u[i];
+    }
+    un[0] = u[0] << shift;
+
+    const DoubleLimb base = (DoubleLimb)1 << LIMB_BITS;
+    for (int j = uLen - vLen; j >= 0; j--) {
+        // Estimate the quotient limb from the top two limbs and refine it with the third
+        DoubleLimb top = ((DoubleLimb)un[j + vLen] << LIMB_BITS) | un[j + vLen - 1];
+        DoubleLimb qhat = top / vn[vLen - 1];
+        DoubleLimb rhat = top % vn[vLen - 1];
+        while (qhat >= base ||
+               qhat * vn[vLen - 2] > ((rhat << LIMB_BITS) | un[j + vLen - 2])) {
+            qhat--;
+            rhat += vn[vLen - 1];
+            if (rhat >= base) {
+                break;
+            }
+        }
+
+        // un[j .. j+vLen] -= qhat * vn
+        Limb carry = 0;
+        Limb borrow = 0;
+        for (int i = 0; i < vLen; i++) {
+            DoubleLimb product = qhat * vn[i] + carry;
+            carry = (Limb)(product >> LIMB_BITS);
+            Limb low = (Limb)product;
+            Limb diff = un[i + j] - low;
+            Limb newBorrow = (un[i + j] < low);
+            newBorrow += (diff < borrow);
+            un[i + j] = diff - borrow;
+            borrow = newBorrow;
+        }
+        Limb diff = un[j + vLen] - carry;
+        Limb overdrawn = (un[j + vLen] < carry);
+        overdrawn |= (diff < borrow);
+        un[j + vLen] = diff - borrow;
+
+        // The estimate was one too large (rare): add the divisor back
+        if (overdrawn) {
+            qhat--;
+            Limb addCarry = 0;
+            for (int i = 0; i < vLen; i++) {
+                Limb sum = un[i + j] + addCarry;
+                addCarry = (sum < addCarry);
+                sum += vn[i];
+                addCarry += (sum < vn[i]);
+                un[i + j] = sum;
+            }
+            un[j + vLen] += addCarry;
+        }
+        quotient[j] = (Limb)qhat;
+    }
+
+    // Undo the normalization on what is left of the dividend
+    for (int i = 0; i < vLen - 1; i++) {
+        remainder[i] = shift ? (un[i] >> shift) | (un[i + 1] << (LIMB_BITS - shift)) : un[i];
+    }
+    remainder[vLen - 1] = un[vLen - 1] >> shift;
+}
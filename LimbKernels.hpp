@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+// Limb kernels shared by the BigHexInt operators and the modular reducers. All of
+// them work on least-significant-first limb arrays and never look at the sign.
+
+// Implementations behind compareLimbs, addLimbs and subLimbs. At startup Automatic
+// picks the fastest one the CPU supports (CPUID); the others exist for testing and
+// benchmarking. CarryChain is available on every x86-64 host.
+enum class LimbKernelSet {
+    Automatic,
+    Portable,      // plain C++, any platform
+    CarryChain,    // _addcarry_u64/_subborrow_u64 chains
+    Avx2,          // 4-limb carry lookahead
+    Avx512         // 8-limb carry lookahead
+};
+
+// Switches the implementation and returns the one now in use; a set the CPU cannot run selects Portable
+LimbKernelSet selectLimbKernels(LimbKernelSet set);
+LimbKernelSet activeLimbKernels();
+bool limbKernelsSupported(LimbKernelSet set);
+const char* limbKernelSetName(LimbKernelSet set);
+
+// Three-way magnitude comparison, leading zero limbs are ignored
+int compareLimbs(const Limb* a, int aLen, const Limb* b, int bLen);
+// result = a + b, requires aLen >= bLen, returns the carry out of limb aLen-1
+Limb addLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+// result = a - b, requires a >= b and aLen >= bLen
+void subLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+// result[0 .. aLen+bLen) = a * b, result must not alias the inputs
+void mulLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+// result[0 .. 2*aLen) = a * a, each cross product computed once; result must not alias a
+void sqrLimbs(Limb* result, const Limb* a, int aLen);
+// Karatsuba over n-limb views: result[0 .. 2n) = a * b, or a * a for the square.
+// The top level always splits once, sub-products split until they are at most
+// baseLimbs long and then use mulLimbs/sqrLimbs. Everything is done in result and
+// scratch, which must hold karatsubaScratchLimbs(n, baseLimbs) limbs; n >= 2 and nothing may alias.
+// Steps of at least parallelLimbs limbs run their three sub-products on threadPool
+// when it has workers.
+void karatsubaMulLimbs(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs, int parallelLimbs, Limb* scratch);
+void karatsubaSqrLimbs(Limb* result, const Limb* a, int n, int baseLimbs, int parallelLimbs, Limb* scratch);
+int karatsubaScratchLimbs(int n, int baseLimbs);
+// Short products of n-limb a and b for reductions that keep one half of a * b (B = 2^64).
+// Schoolbook up to baseLimbs, which skips the other half's limb products; above it
+// Mulders' split does most of the kept half with one Karatsuba product. scratch holds
+// shortProductScratchLimbs(n, baseLimbs) limbs and nothing may alias.
+// result[0 .. n) = a * b mod B^n, exactly
+void mulLowLimbs(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs, Limb* scratch);
+// result[0 .. n) = floor(a * b / B^n) - e for a small e >= 0: at most 1 for schoolbook
+// sizes and below n above them, a few units in practice
+void mulHighLimbs(Limb* result, const Limb* a, const Limb* b, int n, int baseLimbs, Limb* scratch);
+int shortProductScratchLimbs(int n, int baseLimbs);
+// quotient[0 .. uLen-vLen] = u / v and remainder[0 .. vLen) = u % v (Knuth Algorithm D).
+// Requires uLen >= vLen and v[vLen-1] != 0; work holds uLen + vLen + 1 limbs; nothing may alias.
+void divLimbs(Limb* quotient, Limb* remainder, const Limb* u, int uLen,
+              const Limb* v, int vLen, Limb* work);
@@ -0,0 +1,251 @@
+#include "LimbKernelsX86.hpp"
+
+#if defined(LIMB_KERNELS_X86)
+
+#include <algorithm>
+#include <immintrin.h>
+
+bool cpuSupportsAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+bool cpuSupportsAvx512() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+// Finishes a + b over [from, aLen) once b has run out: the carry only travels as far as
+// the first limb that is not all ones, the rest is a plain copy
+static Limb propagateCarry(Limb* result, const Limb* a, int from, int aLen, Limb carry) {
+    int i = from;
+    for (; i < aLen && carry != 0; i++) {
+        result[i] = a[i] + 1;
+        carry = (result[i] == 0);
+    }
+    if (result != a) {
+        std::copy(a + i, a + aLen, result + i);
+    }
+    return carry;
+}
+
+static void propagateBorrow(Limb* result, const Limb* a, int from, int aLen, Limb borrow) {
+    int i = from;
+    for (; i < aLen && borrow != 0; i++) {
+        borrow = (a[i] == 0);
+        result[i] = a[i] - 1;
+    }
+    if (result != a) {
+        std::copy(a + i, a + aLen, result + i);
+    }
+}
+
+static unsigned char addCarryChain(Limb* result, const Limb* a, const Limb* b, int from, int to, unsigned char carry) {
+    unsigned long long sum;
+    for (int i = from; i < to; i++) {
+        carry = _addcarry_u64(carry, a[i], b[i], &sum);
+        result[i] = sum;
+    }
+    return carry;
+}
+
+static unsigned char subBorrowChain(Limb* result, const Limb* a, const Limb* b, int from, int to, unsigned char borrow) {
+    unsigned long long diff;
+    for (int i = from; i < to; i++) {
+        borrow = _subborrow_u64(borrow, a[i], b[i], &diff);
+        result[i] = diff;
+    }
+    return borrow;
+}
+
+Limb addLimbsCarryChain(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    unsigned char carry = 0;
+    unsigned long long s0, s1, s2, s3;
+    int i = 0;
+    for (; i + 4 <= bLen; i += 4) {
+        carry = _addcarry_u64(carry, a[i], b[i], &s0);
+        carry = _addcarry_u64(carry, a[i + 1], b[i + 1], &s1);
+        carry = _addcarry_u64(carry, a[i + 2], b[i + 2], &s2);
+        carry = _addcarry_u64(carry, a[i + 3], b[i + 3], &s3);
+        result[i] = s0;
+        result[i + 1] = s1;
+        result[i + 2] = s2;
+        result[i + 3] = s3;
+    }
+    carry = addCarryChain(result, a, b, i, bLen, carry);
+    return propagateCarry(result, a, bLen, aLen, carry);
+}
+
+void subLimbsCarryChain(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    unsigned char borrow = 0;
+    unsigned long long d0, d1, d2, d3;
+    int i = 0;
+    for (; i + 4 <= bLen; i += 4) {
+        borrow = _subborrow_u64(borrow, a[i], b[i], &d0);
+        borrow = _subborrow_u64(borrow, a[i + 1], b[i + 1], &d1);
+        borrow = _subborrow_u64(borrow, a[i + 2], b[i + 2], &d2);
+        borrow = _subborrow_u64(borrow, a[i + 3], b[i + 3], &d3);
+        result[i] = d0;
+        result[i + 1] = d1;
+        result[i + 2] = d2;
+        result[i + 3] = d3;
+    }
+    borrow = subBorrowChain(result, a, b, i, bLen, borrow);
+    propagateBorrow(result, a, bLen, aLen, borrow);
+}
+
+// Lane i generates a carry (bit i of g) or passes one on (bit i of p, the sum is all
+// ones); g and p never overlap. Adding (g | p) + g + carryIn as ordinary integers
+// reproduces the ripple: bit i of the result XOR p is the carry into lane i and the
+// bit above the last lane is the carry out.
+static inline unsigned resolveCarries(unsigned g, unsigned p, unsigned carryIn, int lanes, unsigned& carryOut) {
+    unsigned x = (g | p) + g + carryIn;
+    carryOut = (x >> lanes) & 1;
+    return (x ^ p) & ((1u << lanes) - 1);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i laneMask(unsigned bits) {
+    __m256i spread = _mm256_srlv_epi64(_mm256_set1_epi64x(bits), _mm256_set_epi64x(3, 2, 1, 0));
+    return _mm256_and_si256(spread, _mm256_set1_epi64x(1));
+}
+
+__attribute__((target("avx2")))
+Limb addLimbsAvx2(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    unsigned carry = 0;
+    int i = 0;
+    for (; i + 4 <= bLen; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i sum = _mm256_add_epi64(va, vb);
+        // Unsigned sum < a, compared as signed after flipping the top bits
+        __m256i generate = _mm256_cmpgt_epi64(_mm256_xor_si256(va, sign), _mm256_xor_si256(sum, sign));
+        __m256i propagate = _mm256_cmpeq_epi64(sum, ones);
+        unsigned g = _mm256_movemask_pd(_mm256_castsi256_pd(generate));
+        unsigned p = _mm256_movemask_pd(_mm256_castsi256_pd(propagate));
+        unsigned carries = resolveCarries(g, p, carry, 4, carry);
+        sum = _mm256_add_epi64(sum, laneMask(carries));
+        _mm256_storeu_si256((__m256i*)(result + i), sum);
+    }
+    carry = addCarryChain(result, a, b, i, bLen, (unsigned char)carry);
+    return propagateCarry(result, a, bLen, aLen, carry);
+}
+
+__attribute__((target("avx2")))
+void subLimbsAvx2(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned borrow = 0;
+    int i = 0;
+    for (; i + 4 <= bLen; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i diff = _mm256_sub_epi64(va, vb);
+        // A lane borrows when a < b and passes a borrow on when its difference is zero
+        __m256i generate = _mm256_cmpgt_epi64(_mm256_xor_si256(vb, sign), _mm256_xor_si256(va, sign));
+        __m256i propagate = _mm256_cmpeq_epi64(diff, zero);
+        unsigned g = _mm256_movemask_pd(_mm256_castsi256_pd(generate));
+        unsigned p = _mm256_movemask_pd(_mm256_castsi256_pd(propagate));
+        unsigned borrows = resolveCarries(g, p, borrow, 4, borrow);
+        diff = _mm256_sub_epi64(diff, laneMask(borrows));
+        _mm256_storeu_si256((__m256i*)(result + i), diff);
+    }
+    borrow = subBorrowChain(result, a, b, i, bLen, (unsigned char)borrow);
+    propagateBorrow(result, a, bLen, aLen, borrow);
+}
+
+__attribute__((target("avx2")))
+int compareLimbsAvx2(const Limb* a, int aLen, const Limb* b, int bLen) {
+    while (aLen > 1 && a[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && b[bLen - 1] == 0) bLen--;
+    if (aLen != bLen) {
+        return (aLen > bLen) ? 1 : -1;
+    }
+    int i = aLen;
+    for (; i >= 4; i -= 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i - 4));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i - 4));
+        unsigned equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(va, vb)));
+        if (equal != 0xF) {
+            int lane = 31 - __builtin_clz(~equal & 0xF);
+            return (a[i - 4 + lane] > b[i - 4 + lane]) ? 1 : -1;
+        }
+    }
+    for (i--; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+// AVX-512 compares unsigned lanes straight into mask registers and adds the carries
+// under a mask, so no sign flipping or lane expansion is needed
+__attribute__((target("avx512f")))
+Limb addLimbsAvx512(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    const __m512i one = _mm512_set1_epi64(1);
+    unsigned carry = 0;
+    int i = 0;
+    for (; i + 8 <= bLen; i += 8) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        __m512i sum = _mm512_add_epi64(va, vb);
+        unsigned g = _mm512_cmplt_epu64_mask(sum, va);
+        unsigned p = _mm512_cmpeq_epu64_mask(sum, ones);
+        unsigned carries = resolveCarries(g, p, carry, 8, carry);
+        sum = _mm512_mask_add_epi64(sum, (__mmask8)carries, sum, one);
+        _mm512_storeu_si512((void*)(result + i), sum);
+    }
+    carry = addCarryChain(result, a, b, i, bLen, (unsigned char)carry);
+    return propagateCarry(result, a, bLen, aLen, carry);
+}
+
+__attribute__((target("avx512f")))
+void subLimbsAvx512(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+    unsigned borrow = 0;
+    int i = 0;
+    for (; i + 8 <= bLen; i += 8) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        __m512i diff = _mm512_sub_epi64(va, vb);
+        unsigned g = _mm512_cmplt_epu64_mask(va, vb);
+        unsigned p = _mm512_cmpeq_epu64_mask(diff, zero);
+        unsigned borrows = resolveCarries(g, p, borrow, 8, borrow);
+        diff = _mm512_mask_sub_epi64(diff, (__mmask8)borrows, diff, one);
+        _mm512_storeu_si512((void*)(result + i), diff);
+    }
+    borrow = subBorrowChain(result, a, b, i, bLen, (unsigned char)borrow);
+    propagateBorrow(result, a, bLen, aLen, borrow);
+}
+
+__attribute__((target("avx512f")))
+int compareLimbsAvx512(const Limb* a, int aLen, const Limb* b, int bLen) {
+    while (aLen > 1 && a[aLen - 1] == 0) aLen--;
+    while (bLen > 1 && b[bLen - 1] == 0) bLen--;
+    if (aLen != bLen) {
+        return (aLen > bLen) ? 1 : -1;
+    }
+    int i = aLen;
+    for (; i >= 8; i -= 8) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i - 8));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i - 8));
+        unsigned differ = _mm512_cmpneq_epu64_mask(va, vb);
+        if (differ != 0) {
+            int lane = 31 - __builtin_clz(differ);
+            return (a[i - 8 + lane] > b[i - 8 + lane]) ? 1 : -1;
+        }
+    }
+    for (i--; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+#endif
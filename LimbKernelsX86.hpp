@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+// x86-64 variants of the add/sub/compare limb kernels. Each is compiled for its own
+// instruction set through a target attribute, so the program itself needs no -m flags
+// and still runs on any x86-64 host; LimbKernels.cpp calls them only after CPUID says
+// the instructions exist. Contracts match the portable kernels in LimbKernels.hpp.
+#if defined(__x86_64__)
+#define LIMB_KERNELS_X86 1
+
+bool cpuSupportsAvx2();
+bool cpuSupportsAvx512();
+
+// _addcarry_u64/_subborrow_u64 chains, unrolled four limbs at a time (baseline x86-64)
+Limb addLimbsCarryChain(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+void subLimbsCarryChain(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+
+// Carry lookahead over 4 (AVX2) or 8 (AVX-512) limbs: the lanes are added independently,
+// then the per-lane generate/propagate masks are resolved with one scalar addition
+Limb addLimbsAvx2(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+void subLimbsAvx2(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+int compareLimbsAvx2(const Limb* a, int aLen, const Limb* b, int bLen);
+Limb addLimbsAvx512(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+void subLimbsAvx512(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+int compareLimbsAvx512(const Limb* a, int aLen, const Limb* b, int bLen);
+
+#endif
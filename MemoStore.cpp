@@ -0,0 +1,781 @@
+#include "MemoStore.hpp"
+#include "KaratsubaCache.hpp"
+#include "exceptions.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoSnapshot memoSnapshot;
+MemoRetentionPolicy memoRetentionPolicy;
+MemoJournal memoJournal;
+
+static uint64_t alignTo8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+static uint64_t recordBytes(uint64_t limbCount) {
+    return sizeof(MemoRecordHeader) + limbCount * sizeof(Limb);
+}
+
+MemoSnapshot::MemoSnapshot() : data(nullptr), size(0), header(nullptr), hitCount(0)
+#ifdef _WIN32
+    , fileHandle(nullptr), mappingHandle(nullptr)
+#else
+    , fd(-1)
+#endif
+{}
+
+MemoSnapshot::~MemoSnapshot() {
+    close();
+}
+
+bool MemoSnapshot::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(MemoFileHeader)) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int handle = ::open(path.c_str(), O_RDONLY);
+    if (handle < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(handle, &info) != 0 || info.st_size < (off_t)sizeof(MemoFileHeader)) {
+        ::close(handle);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+    if (view == MAP_FAILED) {
+        ::close(handle);
+        return false;
+    }
+    fd = handle;
+    size = (size_t)info.st_size;
+#endif
+    data = static_cast<const unsigned char*>(view);
+    header = reinterpret_cast<const MemoFileHeader*>(data);
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MemoSnapshot::close() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(data), size);
+    ::close(fd);
+    fd = -1;
+#endif
+    data = nullptr;
+    header = nullptr;
+    size = 0;
+}
+
+bool MemoSnapshot::isOpen() const {
+    return data != nullptr;
+}
+
+// Checks the header, that every section lies inside the mapping and that every lookup
+// entry addresses hexMultiplyLookup. Counts are compared against the room left after
+// their offset, so huge values cannot wrap the bound around.
+bool MemoSnapshot::validate() const {
+    if (std::memcmp(header->magic, MEMO_FILE_MAGIC, sizeof(MEMO_FILE_MAGIC)) != 0 ||
+        header->version != MEMO_FILE_VERSION ||
+        header->headerSize != sizeof(MemoFileHeader)) {
+        return false;
+    }
+    uint64_t slots = header->indexSlots;
+    if (slots == 0 || (slots & (slots - 1)) != 0) {
+        return false;
+    }
+    if (header->lookupOffset > size || header->indexOffset > size || header->recordsOffset > size ||
+        header->lookupCount > (size - header->lookupOffset) / sizeof(MemoLookupEntry) ||
+        slots > (size - header->indexOffset) / sizeof(uint64_t) ||
+        header->lookupOffset % alignof(MemoLookupEntry) != 0 ||
+        header->indexOffset % 8 != 0 || header->recordsOffset % 8 != 0) {
+        return false;
+    }
+    const MemoLookupEntry* entries = reinterpret_cast<const MemoLookupEntry*>(data + header->lookupOffset);
+    for (uint64_t k = 0; k < header->lookupCount; k++) {
+        if (entries[k].i >= HEX_LOOKUP_SIZE || entries[k].j >= HEX_LOOKUP_SIZE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const MemoRecordHeader* MemoSnapshot::recordAt(uint64_t offset) const {
+    // Offsets come from the file, so they are bounded before anything is added to them
+    if (offset % 8 != 0 || offset > size - header->recordsOffset ||
+        size - header->recordsOffset - offset < sizeof(MemoRecordHeader)) {
+        return nullptr;
+    }
+    uint64_t position = header->recordsOffset + offset;
+    const MemoRecordHeader* record = reinterpret_cast<const MemoRecordHeader*>(data + position);
+    // Every value is stored with at least one limb, and BigHexInt needs that too
+    if (record->aLength == 0 || record->bLength == 0 || record->productLength == 0) {
+        return nullptr;
+    }
+    uint64_t limbCount = (uint64_t)record->aLength + record->bLength + record->productLength;
+    if (recordBytes(limbCount) > size - position) {
+        return nullptr;
+    }
+    return record;
+}
+
+bool MemoSnapshot::find(const BigHexInt& a, const BigHexInt& b, BigHexInt& product, uint32_t* lastUsedDay) const {
+    if (!isOpen() || header->productCount == 0) {
+        return false;
+    }
+    const Limb* x;
+    const Limb* y;
+    int xLen, yLen;
+    KaratsubaCache::canonicalOperands(a, b, x, xLen, y, yLen);
+    uint64_t hash = KaratsubaCache::hashOperands(x, xLen, y, yLen);
+
+    const uint64_t* index = reinterpret_cast<const uint64_t*>(data + header->indexOffset);
+    uint64_t mask = header->indexSlots - 1;
+    for (uint64_t probe = 0, slot = hash & mask; probe <= mask; probe++, slot = (slot + 1) & mask) {
+        if (index[slot] == 0) {
+            return false;
+        }
+        const MemoRecordHeader* record = recordAt(index[slot] - 1);
+        if (record == nullptr) {
+            return false;
+        }
+        if (record->hash != hash || (int)record->aLength != xLen || (int)record->bLength != yLen) {
+            continue;
+        }
+        const Limb* limbs = reinterpret_cast<const Limb*>(record + 1);
+        if (!std::equal(x, x + xLen, limbs) || !std::equal(y, y + yLen, limbs + xLen)) {
+            continue;
+        }
+        product.resize(record->productLength);
+        std::copy(limbs + xLen + yLen, limbs + xLen + yLen + record->productLength, product.limbs);
+        product.isNegative = false;
+        if (lastUsedDay != nullptr) {
+            *lastUsedDay = record->lastUsedDay;
+        }
+        hitCount++;
+        return true;
+    }
+    return false;
+}
+
+uint64_t MemoSnapshot::productCount() const {
+    return isOpen() ? header->productCount : 0;
+}
+
+uint64_t MemoSnapshot::hits() const {
+    return hitCount;
+}
+
+void MemoSnapshot::forEachLookup(const std::function<void(int, int, int)>& visit) const {
+    if (!isOpen()) {
+        return;
+    }
+    const MemoLookupEntry* entries = reinterpret_cast<const MemoLookupEntry*>(data + header->lookupOffset);
+    for (uint64_t k = 0; k < header->lookupCount; k++) {
+        visit(entries[k].i, entries[k].j, entries[k].product);
+    }
+}
+
+void MemoSnapshot::forEachProduct(const std::function<void(const MemoEntry&)>& visit) const {
+    if (!isOpen()) {
+        return;
+    }
+    MemoEntry entry;
+    uint64_t offset = 0;
+    for (uint64_t k = 0; k < header->productCount; k++) {
+        const MemoRecordHeader* record = recordAt(offset);
+        if (record == nullptr) {
+            return;
+        }
+        const Limb* limbs = reinterpret_cast<const Limb*>(record + 1);
+        entry.a.assign(limbs, limbs + record->aLength);
+        entry.b.assign(limbs + record->aLength, limbs + record->aLength + record->bLength);
+        entry.product.assign(limbs + record->aLength + record->bLength,
+                             limbs + record->aLength + record->bLength + record->productLength);
+        entry.lastUsedDay = record->lastUsedDay;
+        visit(entry);
+        offset += recordBytes((uint64_t)record->aLength + record->bLength + record->productLength);
+    }
+}
+
+void MemoSnapshot::write(const std::string& path, std::vector<MemoLookupEntry> lookups, std::vector<MemoEntry> entries) {
+    // Sort and deduplicate the small-product table
+    std::sort(lookups.begin(), lookups.end(), [](const MemoLookupEntry& l, const MemoLookupEntry& r) {
+        return l.i != r.i ? l.i < r.i : l.j < r.j;
+    });
+    lookups.erase(std::unique(lookups.begin(), lookups.end(), [](const MemoLookupEntry& l, const MemoLookupEntry& r) {
+        return l.i == r.i && l.j == r.j;
+    }), lookups.end());
+
+    // Sort products by (hash, a, b) and drop repeated keys, keeping the most recently used copy
+    std::vector<uint64_t> hashes(entries.size());
+    std::vector<size_t> order(entries.size());
+    for (size_t k = 0; k < entries.size(); k++) {
+        const MemoEntry& e = entries[k];
+        hashes[k] = KaratsubaCache::hashOperands(e.a.data(), (int)e.a.size(), e.b.data(), (int)e.b.size());
+        order[k] = k;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+        if (hashes[l] != hashes[r]) return hashes[l] < hashes[r];
+        if (entries[l].a != entries[r].a) return entries[l].a < entries[r].a;
+        if (entries[l].b != entries[r].b) return entries[l].b < entries[r].b;
+        return entries[l].lastUsedDay > entries[r].lastUsedDay;
+    });
+    order.erase(std::unique(order.begin(), order.end(), [&](size_t l, size_t r) {
+        return hashes[l] == hashes[r] && entries[l].a == entries[r].a && entries[l].b == entries[r].b;
+    }), order.end());
+
+    // Power-of-two index kept at most three quarters full
+    uint64_t slots = 16;
+    while (slots * 3 < order.size() * 4) {
+        slots <<= 1;
+    }
+
+    MemoFileHeader fileHeader;
+    std::memset(&fileHeader, 0, sizeof(fileHeader));
+    std::memcpy(fileHeader.magic, MEMO_FILE_MAGIC, sizeof(MEMO_FILE_MAGIC));
+    fileHeader.version = MEMO_FILE_VERSION;
+    fileHeader.headerSize = sizeof(MemoFileHeader);
+    fileHeader.lookupCount = lookups.size();
+    fileHeader.productCount = order.size();
+    fileHeader.indexSlots = slots;
+    fileHeader.lookupOffset = sizeof(MemoFileHeader);
+    fileHeader.indexOffset = alignTo8(fileHeader.lookupOffset + lookups.size() * sizeof(MemoLookupEntry));
+    fileHeader.recordsOffset = fileHeader.indexOffset + slots * sizeof(uint64_t);
+
+    // Lay out the records and build the open-addressed index over them
+    std::vector<uint64_t> index(slots, 0);
+    std::vector<Limb> records;
+    for (size_t k : order) {
+        const MemoEntry& e = entries[k];
+        uint64_t offset = records.size() * sizeof(Limb);
+        MemoRecordHeader record;
+        record.hash = hashes[k];
+        record.aLength = (uint32_t)e.a.size();
+        record.bLength = (uint32_t)e.b.size();
+        record.productLength = (uint32_t)e.product.size();
+        record.lastUsedDay = e.lastUsedDay;
+        const Limb* raw = reinterpret_cast<const Limb*>(&record);
+        records.insert(records.end(), raw, raw + sizeof(record) / sizeof(Limb));
+        records.insert(records.end(), e.a.begin(), e.a.end());
+        records.insert(records.end(), e.b.begin(), e.b.end());
+        records.insert(records.end(), e.product.begin(), e.product.end());
+
+        uint64_t slot = record.hash & (slots - 1);
+        while (index[slot] != 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        index[slot] = offset + 1;
+    }
+
+    std::string tempPath = path + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw FileIOException(tempPath, "open for writing");
+    }
+    file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+    file.write(reinterpret_cast<const char*>(lookups.data()), lookups.size() * sizeof(MemoLookupEntry));
+    static const char padding[8] = {0};
+    file.write(padding, fileHeader.indexOffset - (fileHeader.lookupOffset + lookups.size() * sizeof(MemoLookupEntry)));
+    file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Limb));
+    file.close();
+    if (!file) {
+        throw FileIOException(tempPath, "write");
+    }
+
+    // POSIX rename replaces the old snapshot atomically, so a crash leaves either file
+    // in place. Windows cannot rename over an existing file, so it is removed first.
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        throw FileIOException(path, "replace");
+    }
+}
+
+uint32_t MemoSnapshot::currentDay() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::hours>(now).count() / 24);
+}
+
+void MemoSnapshot::applyRetention(std::vector<MemoEntry>& entries, const MemoRetentionPolicy& policy, uint32_t today) {
+    // Entries from before day stamps existed count as used today
+    for (MemoEntry& entry : entries) {
+        if (entry.lastUsedDay == 0) {
+            entry.lastUsedDay = today;
+        }
+    }
+    if (policy.maxAgeDays != 0) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const MemoEntry& entry) {
+            return entry.lastUsedDay + policy.maxAgeDays < today;
+        }), entries.end());
+    }
+    if (policy.maxEntries == 0 && policy.maxBytes == 0) {
+        return;
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const MemoEntry& l, const MemoEntry& r) {
+        return l.lastUsedDay > r.lastUsedDay;
+    });
+    uint64_t kept = 0;
+    uint64_t bytes = 0;
+    for (const MemoEntry& entry : entries) {
+        uint64_t entryBytes = recordBytes(entry.a.size() + entry.b.size() + entry.product.size());
+        if ((policy.maxEntries != 0 && kept + 1 > policy.maxEntries) ||
+            (policy.maxBytes != 0 && bytes + entryBytes > policy.maxBytes)) {
+            break;
+        }
+        kept++;
+        bytes += entryBytes;
+    }
+    entries.resize(kept);
+}
+
+bool MemoSnapshot::isLegacyTextFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    char magic[sizeof(MEMO_FILE_MAGIC)] = {0};
+    file.read(magic, sizeof(magic));
+    return std::memcmp(magic, MEMO_FILE_MAGIC, sizeof(MEMO_FILE_MAGIC)) != 0;
+}
+
+static std::vector<Limb> limbsOf(const BigHexInt& value) {
+    int len = value.length;
+    while (len > 1 && value.limbs[len - 1] == 0) {
+        len--;
+    }
+    return std::vector<Limb>(value.limbs, value.limbs + len);
+}
+
+static BigHexInt fromLimbs(const std::vector<Limb>& limbs) {
+    BigHexInt value;
+    value.resize((int)limbs.size());
+    std::copy(limbs.begin(), limbs.end(), value.limbs);
+    return value;
+}
+
+void MemoSnapshot::readLegacyText(const std::string& path, std::vector<MemoLookupEntry>& lookups, std::vector<MemoEntry>& entries) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::stringstream ss(line);
+        std::string first, second, third, fourth;
+        std::getline(ss, first, ':');
+        std::getline(ss, second, ':');
+        std::getline(ss, third, ':');
+        try {
+            if (first == "KARATSUBA") {
+                std::getline(ss, fourth);
+                BigHexInt a(second), b(third), product(fourth);
+                const Limb* x;
+                const Limb* y;
+                int xLen, yLen;
+                KaratsubaCache::canonicalOperands(a, b, x, xLen, y, yLen);
+                MemoEntry entry;
+                entry.a.assign(x, x + xLen);
+                entry.b.assign(y, y + yLen);
+                entry.product = limbsOf(product);
+                entries.push_back(std::move(entry));
+            } else if (!third.empty()) {
+                int i = std::stoi(first), j = std::stoi(second);
+                if (i >= 0 && i < HEX_LOOKUP_SIZE && j >= 0 && j < HEX_LOOKUP_SIZE) {
+                    lookups.push_back(MemoLookupEntry{(uint16_t)i, (uint16_t)j, (int32_t)std::stoi(third)});
+                }
+            }
+        }
+        catch (const std::exception&) {
+            // Skip malformed lines, the rest of the file is still usable
+        }
+    }
+}
+
+static uint64_t checksumLimbs(const Limb* limbs, size_t count) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ count;
+    for (size_t k = 0; k < count; k++) {
+        h ^= limbs[k];
+        h *= 0x100000001b3ULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+static std::string journalPath() {
+    return std::string(LOOKUP_FILE) + MEMO_JOURNAL_SUFFIX;
+}
+
+MemoJournal::MemoJournal()
+    : running(false), stopping(false), flushInterval(MEMO_JOURNAL_FLUSH_INTERVAL_MS),
+      compactionThreshold(MEMO_JOURNAL_COMPACT_BYTES), fileBytes(0) {}
+
+MemoJournal::~MemoJournal() {
+    try {
+        stop();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error flushing memoization journal: " << e.what() << std::endl;
+    }
+}
+
+void MemoJournal::start(const std::string& journalFile) {
+    stop();
+    std::error_code error;
+    uint64_t existing = std::filesystem::file_size(journalFile, error);
+    std::lock_guard<std::mutex> lock(mutex);
+    path = journalFile;
+    fileBytes = error ? 0 : existing;
+    running = true;
+    stopping = false;
+    flusher = std::thread(&MemoJournal::run, this);
+}
+
+void MemoJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+        stopping = true;
+    }
+    wake.notify_all();
+    flusher.join();
+    // Anything queued after the flusher's last pass goes out here
+    flush();
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+}
+
+bool MemoJournal::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+void MemoJournal::append(const BigHexInt& a, const BigHexInt& b, const BigHexInt& product, uint32_t lastUsedDay) {
+    const Limb* x;
+    const Limb* y;
+    int xLen, yLen;
+    KaratsubaCache::canonicalOperands(a, b, x, xLen, y, yLen);
+    MemoEntry entry;
+    entry.a.assign(x, x + xLen);
+    entry.b.assign(y, y + yLen);
+    entry.product = limbsOf(product);
+    entry.lastUsedDay = lastUsedDay;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+        pending.push_back(std::move(entry));
+    }
+}
+
+void MemoJournal::flush() {
+    std::vector<MemoEntry> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.swap(pending);
+    }
+    if (!batch.empty()) {
+        writeBatch(batch);
+    }
+}
+
+void MemoJournal::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, flushInterval, [this]() { return stopping; });
+        lock.unlock();
+        try {
+            flush();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error writing memoization journal: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+// Appends one batch; the checksum lets replay() detect a batch cut short by a crash
+void MemoJournal::writeBatch(const std::vector<MemoEntry>& batch) {
+    std::vector<Limb> payload;
+    for (const MemoEntry& e : batch) {
+        MemoRecordHeader record;
+        record.hash = KaratsubaCache::hashOperands(e.a.data(), (int)e.a.size(), e.b.data(), (int)e.b.size());
+        record.aLength = (uint32_t)e.a.size();
+        record.bLength = (uint32_t)e.b.size();
+        record.productLength = (uint32_t)e.product.size();
+        record.lastUsedDay = e.lastUsedDay;
+        const Limb* raw = reinterpret_cast<const Limb*>(&record);
+        payload.insert(payload.end(), raw, raw + sizeof(record) / sizeof(Limb));
+        payload.insert(payload.end(), e.a.begin(), e.a.end());
+        payload.insert(payload.end(), e.b.begin(), e.b.end());
+        payload.insert(payload.end(), e.product.begin(), e.product.end());
+    }
+
+    MemoJournalBatchHeader batchHeader;
+    batchHeader.magic = MEMO_JOURNAL_BATCH_MAGIC;
+    batchHeader.count = (uint32_t)batch.size();
+    batchHeader.payloadBytes = payload.size() * sizeof(Limb);
+    batchHeader.checksum = checksumLimbs(payload.data(), payload.size());
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        throw FileIOException(path, "open for appending");
+    }
+    file.write(reinterpret_cast<const char*>(&batchHeader), sizeof(batchHeader));
+    file.write(reinterpret_cast<const char*>(payload.data()), batchHeader.payloadBytes);
+    file.close();
+    if (!file) {
+        throw FileIOException(path, "append");
+    }
+    std::lock_guard<std::mutex> stateLock(mutex);
+    fileBytes += sizeof(batchHeader) + batchHeader.payloadBytes;
+}
+
+uint64_t MemoJournal::replay(const std::string& journalFile, const std::function<void(const MemoEntry&)>& visit) {
+    std::ifstream file(journalFile, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = (uint64_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    uint64_t valid = 0;
+    std::vector<Limb> payload;
+    MemoEntry entry;
+    MemoJournalBatchHeader batchHeader;
+    while (valid + sizeof(batchHeader) <= fileSize) {
+        file.read(reinterpret_cast<char*>(&batchHeader), sizeof(batchHeader));
+        if (!file || batchHeader.magic != MEMO_JOURNAL_BATCH_MAGIC ||
+            batchHeader.payloadBytes % sizeof(Limb) != 0 ||
+            batchHeader.payloadBytes > fileSize - valid - sizeof(batchHeader)) {
+            break;
+        }
+        payload.resize(batchHeader.payloadBytes / sizeof(Limb));
+        file.read(reinterpret_cast<char*>(payload.data()), batchHeader.payloadBytes);
+        if (!file || checksumLimbs(payload.data(), payload.size()) != batchHeader.checksum) {
+            break;
+        }
+
+        // Parse the whole batch before handing out any of it
+        std::vector<MemoEntry> records;
+        size_t position = 0;
+        const size_t recordLimbs = sizeof(MemoRecordHeader) / sizeof(Limb);
+        bool intact = true;
+        for (uint32_t k = 0; k < batchHeader.count; k++) {
+            if (position + recordLimbs > payload.size()) {
+                intact = false;
+                break;
+            }
+            const MemoRecordHeader* record = reinterpret_cast<const MemoRecordHeader*>(payload.data() + position);
+            size_t limbCount = (size_t)record->aLength + record->bLength + record->productLength;
+            position += recordLimbs;
+            if (record->aLength == 0 || record->bLength == 0 || record->productLength == 0 ||
+                position + limbCount > payload.size()) {
+                intact = false;
+                break;
+            }
+            const Limb* limbs = payload.data() + position;
+            entry.a.assign(limbs, limbs + record->aLength);
+            entry.b.assign(limbs + record->aLength, limbs + record->aLength + record->bLength);
+            entry.product.assign(limbs + record->aLength + record->bLength, limbs + limbCount);
+            entry.lastUsedDay = record->lastUsedDay;
+            records.push_back(entry);
+            position += limbCount;
+        }
+        if (!intact || position != payload.size()) {
+            break;
+        }
+        for (const MemoEntry& e : records) {
+            visit(e);
+        }
+        valid += sizeof(batchHeader) + batchHeader.payloadBytes;
+    }
+    return valid;
+}
+
+void MemoJournal::setFlushInterval(std::chrono::milliseconds interval) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushInterval = interval;
+    }
+    wake.notify_all();
+}
+
+std::chrono::milliseconds MemoJournal::getFlushInterval() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flushInterval;
+}
+
+void MemoJournal::setCompactionThreshold(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    compactionThreshold = bytes;
+}
+
+uint64_t MemoJournal::getCompactionThreshold() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return compactionThreshold;
+}
+
+uint64_t MemoJournal::bytesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fileBytes;
+}
+
+void compactMemoFile() {
+    bool wasRunning = memoJournal.isRunning();
+    memoJournal.stop();
+
+    std::vector<MemoLookupEntry> lookups;
+    memoSnapshot.forEachLookup([&lookups](int i, int j, int product) {
+        lookups.push_back(MemoLookupEntry{(uint16_t)i, (uint16_t)j, (int32_t)product});
+    });
+    // Journal entries go last so write() keeps their fresher day stamps on duplicates
+    std::vector<MemoEntry> entries;
+    memoSnapshot.forEachProduct([&entries](const MemoEntry& entry) {
+        entries.push_back(entry);
+    });
+    MemoJournal::replay(journalPath(), [&entries](const MemoEntry& entry) {
+        entries.push_back(entry);
+    });
+    MemoSnapshot::applyRetention(entries, memoRetentionPolicy, MemoSnapshot::currentDay());
+
+    // The mapping has to be released before the file can be replaced
+    memoSnapshot.close();
+    MemoSnapshot::write(LOOKUP_FILE, std::move(lookups), std::move(entries));
+    std::remove(journalPath().c_str());
+    memoSnapshot.open(LOOKUP_FILE);
+
+    if (wasRunning) {
+        memoJournal.start(journalPath());
+    }
+}
+
+void initializeLookupTable() {
+    try {
+        for (int i = 0; i < HEX_LOOKUP_SIZE; i++) {
+            for (int j = 0; j < HEX_LOOKUP_SIZE; j++) {
+                hexMultiplyLookup[i][j] = -1;
+            }
+        }
+
+        // Old text files are converted once, after that startup only maps the snapshot
+        if (MemoSnapshot::isLegacyTextFile(LOOKUP_FILE)) {
+            std::cout << "Converting lookup file to binary snapshot format..." << std::endl;
+            std::vector<MemoLookupEntry> lookups;
+            std::vector<MemoEntry> entries;
+            MemoSnapshot::readLegacyText(LOOKUP_FILE, lookups, entries);
+            MemoSnapshot::write(LOOKUP_FILE, std::move(lookups), std::move(entries));
+        }
+
+        // Cut off a batch left half-written by a crash so new batches append cleanly
+        std::vector<MemoEntry> journaled;
+        uint64_t journalBytes = MemoJournal::replay(journalPath(), [&journaled](const MemoEntry& entry) {
+            journaled.push_back(entry);
+        });
+        std::error_code error;
+        uint64_t journalSize = std::filesystem::file_size(journalPath(), error);
+        if (!error && journalSize > journalBytes) {
+            std::cout << "Warning: Discarding incomplete memoization journal tail." << std::endl;
+            std::filesystem::resize_file(journalPath(), journalBytes);
+        }
+
+        bool opened = memoSnapshot.open(LOOKUP_FILE);
+        if (journalBytes > 0 && journalBytes >= memoJournal.getCompactionThreshold()) {
+            std::cout << "Compacting memoization journal..." << std::endl;
+            compactMemoFile();
+            opened = memoSnapshot.isOpen();
+        } else {
+            // A short journal is cheaper to replay into the cache than to compact
+            for (const MemoEntry& entry : journaled) {
+                karatsubaCache.insert(fromLimbs(entry.a), fromLimbs(entry.b), fromLimbs(entry.product));
+            }
+        }
+        memoJournal.start(journalPath());
+
+        if (!opened) {
+            std::cout << "Warning: Lookup file not found. Will create new one at the next compaction." << std::endl;
+            return;
+        }
+
+        memoSnapshot.forEachLookup([](int i, int j, int product) {
+            hexMultiplyLookup[i][j] = product;
+        });
+        std::cout << "Lookup table loaded successfully." << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error initializing lookup table: " << e.what() << std::endl;
+    }
+}
+
+// Only the products queued since the last flush are written, the snapshot is left alone
+void closeAndUpdateFile() {
+    try {
+        std::cout << "Updating memoization file..." << std::endl;
+        memoJournal.stop();
+        memoSnapshot.close();
+        std::cout << "Memoization file updated successfully." << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error updating memoization file: " << e.what() << std::endl;
+    }
+}
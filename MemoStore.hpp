@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Binary snapshot of the memoization file (LOOKUP_FILE), version 1.
+ * All fields are native-endian and every section starts on an 8-byte boundary.
+ *
+ *   MemoFileHeader                       fixed 64 bytes
+ *   MemoLookupEntry[lookupCount]         small products, sorted by (i, j)
+ *   uint64_t index[indexSlots]           open-addressed hash index, linear probing;
+ *                                        each slot holds (record offset + 1), 0 = empty
+ *   records                              MemoRecordHeader followed by the a, b and
+ *                                        product limbs, sorted by (hash, a, b), no duplicates
+ *
+ * lastUsedDay counts days since the Unix epoch (0 = unknown) and drives the age policy.
+ * The file is memory-mapped read-only, so lookups read straight from the mapping.
+ */
+constexpr char MEMO_FILE_MAGIC[8] = {'B', 'H', 'X', 'M', 'E', 'M', 'O', '\0'};
+constexpr uint32_t MEMO_FILE_VERSION = 1;
+
+struct MemoFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t lookupCount;
+    uint64_t productCount;
+    uint64_t indexSlots;
+    uint64_t lookupOffset;
+    uint64_t indexOffset;
+    uint64_t recordsOffset;
+};
+
+struct MemoLookupEntry {
+    uint16_t i;
+    uint16_t j;
+    int32_t product;
+};
+
+struct MemoRecordHeader {
+    uint64_t hash;
+    uint32_t aLength;
+    uint32_t bLength;
+    uint32_t productLength;
+    uint32_t lastUsedDay;
+};
+
+// One Karatsuba product in canonical operand order (larger magnitude first)
+struct MemoEntry {
+    std::vector<Limb> a;
+    std::vector<Limb> b;
+    std::vector<Limb> product;
+    uint32_t lastUsedDay = 0;
+};
+
+// What compactMemoFile() keeps when it rewrites the snapshot. Zero disables a limit.
+// Entries older than maxAgeDays are dropped, then the most recently used ones are kept
+// until maxEntries or maxBytes of record data is reached.
+struct MemoRetentionPolicy {
+    uint64_t maxEntries = 0;
+    uint64_t maxBytes = 0;
+    uint32_t maxAgeDays = 0;
+};
+
+// Read-only view of a snapshot file
+class MemoSnapshot {
+public:
+    MemoSnapshot();
+    ~MemoSnapshot();
+    MemoSnapshot(const MemoSnapshot&) = delete;
+    MemoSnapshot& operator=(const MemoSnapshot&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    bool find(const BigHexInt& a, const BigHexInt& b, BigHexInt& product, uint32_t* lastUsedDay = nullptr) const;
+    uint64_t productCount() const;
+    uint64_t hits() const;
+    void forEachLookup(const std::function<void(int, int, int)>& visit) const;
+    void forEachProduct(const std::function<void(const MemoEntry&)>& visit) const;
+
+    // Sorts, deduplicates and writes a snapshot to path via a temporary file
+    static void write(const std::string& path, std::vector<MemoLookupEntry> lookups, std::vector<MemoEntry> entries);
+    // True when path exists and does not start with the snapshot magic
+    static bool isLegacyTextFile(const std::string& path);
+    // Parses the old "i:j:product" / "KARATSUBA:a:b:product" text format
+    static void readLegacyText(const std::string& path, std::vector<MemoLookupEntry>& lookups, std::vector<MemoEntry>& entries);
+    // Applies the age and size limits of policy to entries
+    static void applyRetention(std::vector<MemoEntry>& entries, const MemoRetentionPolicy& policy, uint32_t today);
+    static uint32_t currentDay();
+
+private:
+    const unsigned char* data;
+    size_t size;
+    const MemoFileHeader* header;
+    mutable uint64_t hitCount;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    const MemoRecordHeader* recordAt(uint64_t offset) const;
+    bool validate() const;
+};
+
+/*
+ * Append-only journal of products found since the last compaction (LOOKUP_FILE + ".journal").
+ * The file is a sequence of batches, each a MemoJournalBatchHeader followed by payloadBytes
+ * of records laid out exactly like snapshot records. A batch whose checksum does not match
+ * is a torn write from a crash; replay stops there and the tail is cut off.
+ */
+constexpr const char* MEMO_JOURNAL_SUFFIX = ".journal";
+constexpr uint32_t MEMO_JOURNAL_BATCH_MAGIC = 0x4c4e4a42;   // "BJNL"
+constexpr int MEMO_JOURNAL_FLUSH_INTERVAL_MS = 1000;
+constexpr uint64_t MEMO_JOURNAL_COMPACT_BYTES = 8 * 1024 * 1024;
+
+struct MemoJournalBatchHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t payloadBytes;
+    uint64_t checksum;
+};
+
+// Collects new products and appends them in batches from a background flusher thread
+class MemoJournal {
+public:
+    MemoJournal();
+    ~MemoJournal();
+    MemoJournal(const MemoJournal&) = delete;
+    MemoJournal& operator=(const MemoJournal&) = delete;
+
+    // start() launches the flusher for path; stop() writes what is still queued and joins it
+    void start(const std::string& path);
+    void stop();
+    bool isRunning() const;
+
+    // Queues one product, a no-op while the journal is not running
+    void append(const BigHexInt& a, const BigHexInt& b, const BigHexInt& product, uint32_t lastUsedDay);
+    // Writes the queued products now instead of waiting for the next interval
+    void flush();
+
+    void setFlushInterval(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getFlushInterval() const;
+    // Journal size at which initializeLookupTable() folds it into the snapshot
+    void setCompactionThreshold(uint64_t bytes);
+    uint64_t getCompactionThreshold() const;
+    uint64_t bytesWritten() const;
+
+    // Visits every intact record of the journal at path and returns the length of its valid prefix
+    static uint64_t replay(const std::string& path, const std::function<void(const MemoEntry&)>& visit);
+
+private:
+    std::string path;
+    std::vector<MemoEntry> pending;
+    mutable std::mutex mutex;
+    std::mutex fileMutex;
+    std::condition_variable wake;
+    std::thread flusher;
+    bool running;
+    bool stopping;
+    std::chrono::milliseconds flushInterval;
+    uint64_t compactionThreshold;
+    uint64_t fileBytes;
+
+    void run();
+    void writeBatch(const std::vector<MemoEntry>& batch);
+};
+
+// Snapshot mapped at startup by initializeLookupTable(); multiplyMagnitude() falls back to it on cache misses
+extern MemoSnapshot memoSnapshot;
+extern MemoRetentionPolicy memoRetentionPolicy;
+extern MemoJournal memoJournal;
+
+// Folds the journal into a new snapshot, applying memoRetentionPolicy, and empties the journal
+void compactMemoFile();
@@ -0,0 +1,413 @@
+#include "Montgomery.hpp"
+#include "Exponentiation.hpp"
+#include "LimbKernels.hpp"
+#include "MultiplyTuning.hpp"
+#include "exceptions.hpp"
+
+#include <limits>
+
+// Residues modulo B - 1 = 2^64 - 1, where every power of B is 1. Both 0 and B - 1
+// stand for zero; callers only compare differences that are known to be small.
+static Limb addResidue(Limb x, Limb y) {
+    Limb sum = x + y;
+    return sum + (sum < x);
+}
+
+static Limb subResidue(Limb x, Limb y) {
+    return (x - y) - (x < y);
+}
+
+static Limb mulResidue(Limb x, Limb y) {
+    DoubleLimb product = (DoubleLimb)x * y;
+    return addResidue((Limb)product, (Limb)(product >> LIMB_BITS));
+}
+
+static Limb residueLimbs(const Limb* x, int len) {
+    Limb sum = 0;
+    for (int i = 0; i < len; i++) {
+        sum = addResidue(sum, x[i]);
+    }
+    return sum;
+}
+
+MontgomeryContext::MontgomeryContext(const BigHexInt& value) : modulus(value) {
+    modulus.isNegative = false;
+    if (!modulus.isOdd() || modulus.isOne()) {
+        throw InvalidInputException("Montgomery modulus must be odd and greater than one: " + value.toString());
+    }
+    n = modulus.length;
+    while (n > 1 && modulus.limbs[n - 1] == 0) {
+        n--;
+    }
+    modulus.resize(n);
+
+    // Newton iteration for modulus^-1 mod 2^64; each step doubles the correct low bits
+    Limb x = modulus.limbs[0];
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - modulus.limbs[0] * x;
+    }
+    inverse = (Limb)0 - x;
+
+    // Newton's iteration y <- y * (2 - modulus * y) doubles the correct low limbs of
+    // modulus^-1 mod R per step, starting from the one-limb inverse
+    shortProducts = n > MONTGOMERY_SHORT_PRODUCT_THRESHOLD;
+    if (shortProducts) {
+        int base = multiplyThresholds.karatsuba;
+        std::vector<Limb> y(n, 0), e(n), next(n), work;
+        y[0] = x;
+        for (int len = 1; len < n;) {
+            len = std::min(2 * len, n);
+            work.resize(std::max(work.size(), (size_t)shortProductScratchLimbs(len, base)));
+            mulLowLimbs(e.data(), modulus.limbs, y.data(), len, base, work.data());
+            // 2 - e = ~e + 3 modulo B^len
+            for (int i = 0; i < len; i++) {
+                e[i] = ~e[i];
+            }
+            Limb three = 3;
+            addLimbs(e.data(), e.data(), len, &three, 1);
+            mulLowLimbs(next.data(), y.data(), e.data(), len, base, work.data());
+            std::copy(next.begin(), next.begin() + len, y.begin());
+        }
+        // -y = ~y + 1
+        Limb unit = 1;
+        negInverse.resize(n);
+        for (int i = 0; i < n; i++) {
+            negInverse[i] = ~y[i];
+        }
+        addLimbs(negInverse.data(), negInverse.data(), n, &unit, 1);
+        modulusResidue = residueLimbs(modulus.limbs, n);
+    }
+
+    BigHexInt r("1");
+    r <<= n * LIMB_BITS;
+    r %= modulus;
+    one.assign(n, 0);
+    std::copy(r.limbs, r.limbs + r.length, one.begin());
+
+    BigHexInt r2("1");
+    r2 <<= 2 * n * LIMB_BITS;
+    r2 %= modulus;
+    rSquared.assign(n, 0);
+    std::copy(r2.limbs, r2.limbs + r2.length, rSquared.begin());
+}
+
+const BigHexInt& MontgomeryContext::getModulus() const {
+    return modulus;
+}
+
+int MontgomeryContext::limbCount() const {
+    return n;
+}
+
+// Coarsely integrated operand scanning (CIOS): interleave one row of a * b
+// with one step of the reduction so the running total never exceeds n + 2 limbs
+void MontgomeryContext::montMul(Limb* out, const Limb* a, const Limb* b, Limb* t) const {
+    if (shortProducts) {
+        int base = multiplyThresholds.karatsuba;
+        if (n <= base) {
+            mulLimbs(t, a, n, b, n);
+        } else {
+            karatsubaMulLimbs(t, a, b, n, base, std::numeric_limits<int>::max(), t + 2 * n + 1);
+        }
+        reduceShort(out, t, t + 2 * n + 1);
+        return;
+    }
+    const Limb* m = modulus.limbs;
+    std::fill(t, t + n + 2, 0);
+    for (int i = 0; i < n; i++) {
+        Limb carry = 0;
+        for (int j = 0; j < n; j++) {
+            DoubleLimb cur = (DoubleLimb)a[j] * b[i] + t[j] + carry;
+            t[j] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        DoubleLimb top = (DoubleLimb)t[n] + carry;
+        t[n] = (Limb)top;
+        t[n + 1] = (Limb)(top >> LIMB_BITS);
+
+        // Add q * modulus so the lowest limb becomes zero, then drop it
+        Limb q = t[0] * inverse;
+        DoubleLimb cur = (DoubleLimb)q * m[0] + t[0];
+        carry = (Limb)(cur >> LIMB_BITS);
+        for (int j = 1; j < n; j++) {
+            cur = (DoubleLimb)q * m[j] + t[j] + carry;
+            t[j - 1] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        top = (DoubleLimb)t[n] + carry;
+        t[n - 1] = (Limb)top;
+        t[n] = t[n + 1] + (Limb)(top >> LIMB_BITS);
+    }
+
+    finish(out, t);
+}
+
+// Separated operand scanning (SOS) for squares: sqrLimbs computes each cross
+// product once, then n reduction rows clear the low half of the 2n-limb square
+void MontgomeryContext::montSqr(Limb* out, const Limb* a, Limb* t) const {
+    if (shortProducts) {
+        int base = multiplyThresholds.karatsubaSquare;
+        if (n <= base) {
+            sqrLimbs(t, a, n);
+        } else {
+            karatsubaSqrLimbs(t, a, n, base, std::numeric_limits<int>::max(), t + 2 * n + 1);
+        }
+        reduceShort(out, t, t + 2 * n + 1);
+        return;
+    }
+    const Limb* m = modulus.limbs;
+    sqrLimbs(t, a, n);
+    // Each row's carry lands one limb above the row, the next row picks it up
+    Limb extra = 0;
+    for (int i = 0; i < n; i++) {
+        Limb q = t[i] * inverse;
+        Limb carry = 0;
+        for (int j = 0; j < n; j++) {
+            DoubleLimb cur = (DoubleLimb)q * m[j] + t[i + j] + carry;
+            t[i + j] = (Limb)cur;
+            carry = (Limb)(cur >> LIMB_BITS);
+        }
+        DoubleLimb top = (DoubleLimb)t[i + n] + carry + extra;
+        t[i + n] = (Limb)top;
+        extra = (Limb)(top >> LIMB_BITS);
+    }
+    t[2 * n] = extra;
+    finish(out, t + n);
+}
+
+// Separated reduction (REDC) with m = (t mod R) * negInverse mod R:
+// (t + m * modulus) / R = t / R + m * modulus / R + [t mod R != 0], because
+// m * modulus ends in exactly R - (t mod R). So only the high half of m * modulus is
+// computed. mulHighLimbs may come out e < n short; e is recovered exactly from the
+// residues mod B - 1 of m, the modulus and the known low half.
+void MontgomeryContext::reduceShort(Limb* out, Limb* t, Limb* scratch) const {
+    int base = multiplyThresholds.karatsuba;
+    Limb* m = scratch;
+    Limb* high = m + n;
+    Limb* work = high + n;
+
+    mulLowLimbs(m, t, negInverse.data(), n, base, work);
+    mulHighLimbs(high, m, modulus.limbs, n, base, work);
+
+    bool lowNonZero = std::any_of(t, t + n, [](Limb limb) { return limb != 0; });
+    Limb lowResidue = lowNonZero ? subResidue(1, residueLimbs(t, n)) : 0;
+    Limb trueHigh = subResidue(mulResidue(residueLimbs(m, n), modulusResidue), lowResidue);
+    Limb error = subResidue(trueHigh, residueLimbs(high, n));
+    if (error != ~(Limb)0) {
+        addLimbs(high, high, n, &error, 1);
+    }
+
+    t[2 * n] = addLimbs(t + n, t + n, n, high, n);
+    if (lowNonZero) {
+        Limb unit = 1;
+        addLimbs(t + n, t + n, n + 1, &unit, 1);
+    }
+    finish(out, t + n);
+}
+
+// The quadratic loops need at most 2n + 2 limbs; the separated reduction takes the
+// 2n + 1 limb product, m and the high half, then the scratch of the larger of its products
+int MontgomeryContext::scratchLimbs() const {
+    if (!shortProducts) {
+        return 2 * n + 2;
+    }
+    int base = multiplyThresholds.karatsuba;
+    int squareBase = multiplyThresholds.karatsubaSquare;
+    int product = std::max(n > base ? karatsubaScratchLimbs(n, base) : 0,
+                           n > squareBase ? karatsubaScratchLimbs(n, squareBase) : 0);
+    return 2 * n + 1 + std::max(product, 2 * n + shortProductScratchLimbs(n, base));
+}
+
+// The result is below 2 * modulus, one conditional subtraction finishes it
+void MontgomeryContext::finish(Limb* out, const Limb* t) const {
+    const Limb* m = modulus.limbs;
+    bool subtract = t[n] != 0;
+    if (!subtract) {
+        subtract = true;
+        for (int i = n - 1; i >= 0; i--) {
+            if (t[i] != m[i]) {
+                subtract = t[i] > m[i];
+                break;
+            }
+        }
+    }
+    if (subtract) {
+        Limb borrow = 0;
+        for (int i = 0; i < n; i++) {
+            Limb diff = t[i] - m[i];
+            Limb newBorrow = (t[i] < m[i]);
+            newBorrow += (diff < borrow);
+            out[i] = diff - borrow;
+            borrow = newBorrow;
+        }
+    } else {
+        std::copy(t, t + n, out);
+    }
+}
+
+// Copies a value already reduced below the modulus into an n-limb array
+void MontgomeryContext::load(const BigHexInt& value, Limb* out) const {
+    std::fill(out, out + n, 0);
+    int used = std::min(value.length, n);
+    std::copy(value.limbs, value.limbs + used, out);
+}
+
+BigHexInt MontgomeryContext::store(const Limb* value) const {
+    BigHexInt result;
+    result.resize(n);
+    std::copy(value, value + n, result.limbs);
+    result.trim();
+    return result;
+}
+
+BigHexInt MontgomeryContext::toMontgomery(const BigHexInt& value) const {
+    BigHexInt reduced = value % modulus;
+    if (reduced.isNegative) {
+        reduced += modulus;
+    }
+    std::vector<Limb> x(n), scratch(scratchLimbs());
+    load(reduced, x.data());
+    montMul(x.data(), x.data(), rSquared.data(), scratch.data());
+    return store(x.data());
+}
+
+BigHexInt MontgomeryContext::fromMontgomery(const BigHexInt& value) const {
+    std::vector<Limb> x(n), unit(n, 0), scratch(scratchLimbs());
+    load(value, x.data());
+    unit[0] = 1;
+    montMul(x.data(), x.data(), unit.data(), scratch.data());
+    return store(x.data());
+}
+
+BigHexInt MontgomeryContext::multiply(const BigHexInt& a, const BigHexInt& b) const {
+    std::vector<Limb> x(n), y(n), scratch(scratchLimbs());
+    load(a, x.data());
+    load(b, y.data());
+    montMul(x.data(), x.data(), y.data(), scratch.data());
+    return store(x.data());
+}
+
+BigHexInt MontgomeryContext::modPow(const BigHexInt& base, const BigHexInt& exponent) const {
+    if (exponent.isNegative) {
+        throw std::invalid_argument("Negative exponents not supported in modular exponentiation");
+    }
+
+    BigHexInt reduced = base % modulus;
+    if (reduced.isNegative) {
+        reduced += modulus;
+    }
+    std::vector<Limb> x(n), scratch(scratchLimbs());
+    load(reduced, x.data());
+    montMul(x.data(), x.data(), rSquared.data(), scratch.data());
+
+    std::vector<Limb> result = windowedPow(x, one, exponent,
+        [this, &scratch](std::vector<Limb>& out, const std::vector<Limb>& a, const std::vector<Limb>& b) {
+            if (&a == &b) {
+                montSqr(out.data(), a.data(), scratch.data());
+            } else {
+                montMul(out.data(), a.data(), b.data(), scratch.data());
+            }
+        });
+
+    // Multiplying by plain 1 divides out R
+    std::fill(x.begin(), x.end(), 0);
+    x[0] = 1;
+    montMul(result.data(), result.data(), x.data(), scratch.data());
+    return store(result.data());
+}
+
+FixedBaseContext::FixedBaseContext(const BigHexInt& g, const BigHexInt& modulus, int maxExponentBits)
+    : context(modulus), base(g) {
+    int n = context.n;
+    if (maxExponentBits <= 0) {
+        maxExponentBits = ExponentBitIterator(context.modulus).length();
+    }
+
+    // Pick the width that minimizes windows + 2^w multiplications per call
+    width = 1;
+    for (int w = 2; w <= 16; w++) {
+        int cost = (maxExponentBits + w - 1) / w + (1 << w);
+        int best = (maxExponentBits + width - 1) / width + (1 << width);
+        if (cost < best) {
+            width = w;
+        }
+    }
+    windows = (maxExponentBits + width - 1) / width;
+
+    // table[i] = g^(2^(width*i)), each entry width squarings after the previous one
+    BigHexInt reduced = context.toMontgomery(base);
+    table.assign((size_t)windows * n, 0);
+    std::vector<Limb> scratch(context.scratchLimbs());
+    std::copy(reduced.limbs, reduced.limbs + std::min(reduced.length, n), table.begin());
+    for (int i = 1; i < windows; i++) {
+        Limb* entry = table.data() + (size_t)i * n;
+        std::copy(entry - n, entry, entry);
+        for (int s = 0; s < width; s++) {
+            context.montSqr(entry, entry, scratch.data());
+        }
+    }
+}
+
+BigHexInt FixedBaseContext::pow(const BigHexInt& exponent) const {
+    if (exponent.isNegative) {
+        throw std::invalid_argument("Negative exponents not supported in modular exponentiation");
+    }
+    ExponentBitIterator bits(exponent);
+    if (bits.length() > windows * width) {
+        return context.modPow(base, exponent);
+    }
+
+    // Bucket the windows by digit value, largest digit first
+    int digits = 1 << width;
+    std::vector<std::vector<int>> buckets(digits);
+    for (int i = 0; i * width < bits.length(); i++) {
+        int low = i * width;
+        unsigned digit = bits.window(std::min(low + width, bits.length()) - 1, low);
+        if (digit != 0) {
+            buckets[digit].push_back(i);
+        }
+    }
+
+    // A = product over d of B_d, where B_d collects every table entry whose digit is >= d
+    int n = context.n;
+    std::vector<Limb> a(context.one), b(context.one), scratch(context.scratchLimbs());
+    bool aIsOne = true;
+    bool bIsOne = true;
+    for (int d = digits - 1; d >= 1; d--) {
+        for (int i : buckets[d]) {
+            const Limb* entry = table.data() + (size_t)i * n;
+            if (bIsOne) {
+                std::copy(entry, entry + n, b.begin());
+                bIsOne = false;
+            } else {
+                context.montMul(b.data(), b.data(), entry, scratch.data());
+            }
+        }
+        if (bIsOne) {
+            continue;
+        }
+        if (aIsOne) {
+            a = b;
+            aIsOne = false;
+        } else {
+            context.montMul(a.data(), a.data(), b.data(), scratch.data());
+        }
+    }
+
+    std::fill(b.begin(), b.end(), 0);
+    b[0] = 1;
+    context.montMul(a.data(), a.data(), b.data(), scratch.data());
+    return context.store(a.data());
+}
+
+const MontgomeryContext& FixedBaseContext::getContext() const {
+    return context;
+}
+
+int FixedBaseContext::windowWidth() const {
+    return width;
+}
+
+int FixedBaseContext::tableSize() const {
+    return windows;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+#include <vector>
+
+// Moduli longer than this many limbs are reduced with short products (see reduceShort)
+// instead of the quadratic interleaved loop
+constexpr int MONTGOMERY_SHORT_PRODUCT_THRESHOLD = 48;
+
+// Precomputed state for arithmetic modulo one odd modulus n in Montgomery form,
+// where x is stored as x * R mod n with R = 2^(64 * limbCount()). A Montgomery
+// product needs two limb multiplications per limb pair and no division, so a
+// context built once per modulus makes every later multiplication cheap.
+class MontgomeryContext {
+public:
+    // Throws InvalidInputException unless modulus is odd and greater than one
+    explicit MontgomeryContext(const BigHexInt& modulus);
+
+    const BigHexInt& getModulus() const;
+    int limbCount() const;
+
+    // Conversions between ordinary values (any sign or size) and Montgomery form
+    BigHexInt toMontgomery(const BigHexInt& value) const;
+    BigHexInt fromMontgomery(const BigHexInt& value) const;
+    // Montgomery product a * b / R mod n of two values already in Montgomery form
+    BigHexInt multiply(const BigHexInt& a, const BigHexInt& b) const;
+
+    // base^exponent mod n; base is an ordinary value, exponent must not be negative
+    BigHexInt modPow(const BigHexInt& base, const BigHexInt& exponent) const;
+
+private:
+    friend class FixedBaseContext;
+
+    BigHexInt modulus;
+    int n;
+    Limb inverse;              // -modulus^-1 mod 2^64
+    std::vector<Limb> rSquared; // R^2 mod n, used to enter Montgomery form
+    std::vector<Limb> one;      // R mod n, i.e. 1 in Montgomery form
+    bool shortProducts;         // reduce through reduceShort
+    std::vector<Limb> negInverse; // -modulus^-1 mod R, only for reduceShort
+    Limb modulusResidue;        // modulus mod (2^64 - 1), only for reduceShort
+
+    // out = a * b / R mod n over n-limb arrays; scratch holds scratchLimbs() limbs, out may alias a or b
+    void montMul(Limb* out, const Limb* a, const Limb* b, Limb* scratch) const;
+    // out = a * a / R mod n, squaring first and reducing the double-width result after
+    void montSqr(Limb* out, const Limb* a, Limb* scratch) const;
+    // out = t / R mod n for t[0 .. 2n] below n * R, with Karatsuba-based short products
+    void reduceShort(Limb* out, Limb* t, Limb* scratch) const;
+    // out = t mod n for t[0 .. n] below 2n
+    void finish(Limb* out, const Limb* t) const;
+    int scratchLimbs() const;
+    void load(const BigHexInt& value, Limb* out) const;
+    BigHexInt store(const Limb* value) const;
+};
+
+// Powers of one fixed base g modulo one odd modulus, e.g. the DH generator.
+// The table holds g^(2^(w*i)) in Montgomery form for every w-bit window of the
+// exponent; pow() then buckets the exponent's windows by digit value (Yao /
+// Brickell-Gordon-McCurley-Wilson), which costs about exponentBits / w + 2^w
+// multiplications and no squarings at all.
+class FixedBaseContext {
+public:
+    // The table covers exponents up to maxExponentBits, by default the bit length of the modulus
+    FixedBaseContext(const BigHexInt& base, const BigHexInt& modulus, int maxExponentBits = 0);
+
+    // base^exponent mod modulus; longer exponents fall back to the sliding window path
+    BigHexInt pow(const BigHexInt& exponent) const;
+
+    const MontgomeryContext& getContext() const;
+    int windowWidth() const;
+    int tableSize() const;
+
+private:
+    MontgomeryContext context;
+    BigHexInt base;
+    int width;
+    int windows;
+    std::vector<Limb> table;   // windows entries of context.limbCount() limbs each
+};
@@ -0,0 +1,206 @@
+#include "MultiplyTuning.hpp"
+#include "KaratsubaCache.hpp"
+#include "ThreadPool.hpp"
+#include "exceptions.hpp"
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <random>
+#include <sstream>
+
+MultiplyThresholds multiplyThresholds;
+
+namespace {
+
+constexpr int NEVER = std::numeric_limits<int>::max();
+// Smallest base case that keeps the recursions shrinking: a split of fewer limbs can
+// produce sub-products as long as its operands
+constexpr int MIN_SPLIT_LIMBS = 4;
+
+BigHexInt randomOperand(std::mt19937_64& rng, int limbs) {
+    BigHexInt value;
+    value.resize(limbs);
+    for (int i = 0; i < limbs; i++) {
+        value.limbs[i] = rng();
+    }
+    value.limbs[limbs - 1] |= (Limb)1 << (LIMB_BITS - 1);
+    return value;
+}
+
+// Nanoseconds per call, best of three runs that each last at least a millisecond
+double bestTime(const std::function<void()>& operation) {
+    using Clock = std::chrono::steady_clock;
+    auto run = [&operation](int reps) {
+        auto start = Clock::now();
+        for (int r = 0; r < reps; r++) {
+            operation();
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    int reps = 1;
+    while (run(reps) < 1e6 && reps < (1 << 20)) {
+        reps *= 2;
+    }
+    double best = std::numeric_limits<double>::max();
+    for (int trial = 0; trial < 3; trial++) {
+        best = std::min(best, run(reps) / reps);
+    }
+    return best;
+}
+
+// Index of the first size at which the challenger is faster there and at the next
+// size too, so one noisy measurement does not move a threshold; -1 if it never is
+int findCrossover(const std::vector<int>& sizes, const std::function<double(int)>& incumbent,
+                  const std::function<double(int)>& challenger) {
+    bool previousWon = false;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        bool won = challenger(sizes[i]) < incumbent(sizes[i]);
+        if (won && previousWon) {
+            return (int)i - 1;
+        }
+        previousWon = won;
+    }
+    return previousWon ? (int)sizes.size() - 1 : -1;
+}
+
+} // namespace
+
+bool MultiplyThresholds::isValid() const {
+    return karatsuba >= MIN_SPLIT_LIMBS && karatsubaSquare >= MIN_SPLIT_LIMBS &&
+           toom3 > karatsuba && ntt > karatsuba && parallel >= MIN_SPLIT_LIMBS;
+}
+
+bool loadMultiplyProfile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string key;
+    int version = 0;
+    if (!(file >> key >> version) || key != "multiply-profile" || version != MULTIPLY_PROFILE_VERSION) {
+        std::cout << "Warning: Ignoring multiplication profile with an unknown format." << std::endl;
+        return false;
+    }
+
+    MultiplyThresholds loaded;
+    int threads = 1;
+    int value;
+    while (file >> key >> value) {
+        if (key == "karatsuba") loaded.karatsuba = value;
+        else if (key == "toom3") loaded.toom3 = value;
+        else if (key == "ntt") loaded.ntt = value;
+        else if (key == "karatsuba_square") loaded.karatsubaSquare = value;
+        else if (key == "parallel") loaded.parallel = value;
+        else if (key == "threads") threads = value;
+    }
+    if (!loaded.isValid() || threads < 0) {
+        std::cout << "Warning: Ignoring multiplication profile with invalid thresholds." << std::endl;
+        return false;
+    }
+    multiplyThresholds = loaded;
+    threadPool.setThreadBudget(threads);
+    return true;
+}
+
+void saveMultiplyProfile(const std::string& path) {
+    std::ostringstream text;
+    text << "multiply-profile " << MULTIPLY_PROFILE_VERSION << "\n"
+         << "karatsuba " << multiplyThresholds.karatsuba << "\n"
+         << "toom3 " << multiplyThresholds.toom3 << "\n"
+         << "ntt " << multiplyThresholds.ntt << "\n"
+         << "karatsuba_square " << multiplyThresholds.karatsubaSquare << "\n"
+         << "parallel " << multiplyThresholds.parallel << "\n"
+         << "threads " << threadPool.getThreadBudget() << "\n";
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        throw FileIOException(path, "open for writing");
+    }
+    file << text.str();
+    if (!file) {
+        throw FileIOException(path, "write");
+    }
+}
+
+// Each threshold is tuned with the ones below it already in place, the same way the
+// dispatcher will use them. A Karatsuba challenger runs its whole recursion in its own
+// workspace (karatsubaMulLimbs) down to schoolbook at multiplyThresholds.karatsuba;
+// a Toom-3 challenger does one split and hands its five products to the dispatcher.
+MultiplyThresholds tuneMultiplyThresholds() {
+    // Repeated operands would be answered by the memo cache instead of being multiplied,
+    // and the crossovers are between serial algorithms
+    bool cacheWasEnabled = karatsubaCache.isEnabled();
+    karatsubaCache.setEnabled(false);
+    int threadsWere = threadPool.getThreadBudget();
+    threadPool.setThreadBudget(1);
+    MultiplyThresholds saved = multiplyThresholds;
+    MultiplyThresholds tuned;
+    tuned.toom3 = NEVER;
+    tuned.ntt = NEVER;
+    tuned.parallel = saved.parallel;
+    multiplyThresholds = tuned;
+    std::mt19937_64 rng(12345);
+
+    auto timeProduct = [&rng](int limbs, MultiplyAlgorithm algorithm) {
+        BigHexInt a = randomOperand(rng, limbs);
+        BigHexInt b = randomOperand(rng, limbs);
+        return bestTime([&]() { a.multiply(b, algorithm); });
+    };
+
+    // Karatsuba: schoolbook at n against one split whose halves are schoolbook products
+    std::vector<int> sizes = {4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 256};
+    int found = findCrossover(sizes,
+        [&](int n) { multiplyThresholds.karatsuba = n; return timeProduct(n, MultiplyAlgorithm::Schoolbook); },
+        [&](int n) { multiplyThresholds.karatsuba = n; return timeProduct(n, MultiplyAlgorithm::Karatsuba); });
+    tuned.karatsuba = (found > 0) ? sizes[found - 1] : (found == 0 ? MIN_SPLIT_LIMBS : sizes.back());
+    multiplyThresholds.karatsuba = tuned.karatsuba;
+    std::cout << "Karatsuba from " << tuned.karatsuba + 1 << " limbs" << std::endl;
+
+    // Toom-3: a full in-place Karatsuba recursion against one Toom-3 split whose products
+    // go back through the dispatcher, and so are Karatsuba at these sizes
+    sizes.clear();
+    for (int n : {12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024}) {
+        if (n > tuned.karatsuba) {
+            sizes.push_back(n);
+        }
+    }
+    found = findCrossover(sizes,
+        [&](int n) { return timeProduct(n, MultiplyAlgorithm::Karatsuba); },
+        [&](int n) { return timeProduct(n, MultiplyAlgorithm::Toom3); });
+    tuned.toom3 = (found >= 0) ? sizes[found] : NEVER;
+    multiplyThresholds.toom3 = tuned.toom3;
+    std::cout << "Toom-3 from " << tuned.toom3 << " limbs" << std::endl;
+
+    // NTT: the dispatcher as tuned so far against a single transform
+    sizes.clear();
+    for (int n : {64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192, 12288, 16384, 24576, 32768, 49152, 65536}) {
+        if (n > tuned.karatsuba) {
+            sizes.push_back(n);
+        }
+    }
+    found = findCrossover(sizes,
+        [&](int n) { return timeProduct(n, MultiplyAlgorithm::Automatic); },
+        [&](int n) { return timeProduct(n, MultiplyAlgorithm::Ntt); });
+    tuned.ntt = (found >= 0) ? sizes[found] : NEVER;
+    std::cout << "NTT from " << tuned.ntt << " limbs" << std::endl;
+
+    // Squaring: the schoolbook square kernel against one Karatsuba squaring step
+    sizes = {8, 12, 16, 20, 24, 28, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 256};
+    auto timeSquare = [&rng](int limbs) {
+        BigHexInt a = randomOperand(rng, limbs);
+        return bestTime([&]() { a.square(); });
+    };
+    found = findCrossover(sizes,
+        [&](int n) { multiplyThresholds.karatsubaSquare = n; return timeSquare(n); },
+        [&](int n) { multiplyThresholds.karatsubaSquare = n - 1; return timeSquare(n); });
+    tuned.karatsubaSquare = (found > 0) ? sizes[found - 1] : (found == 0 ? MIN_SPLIT_LIMBS : sizes.back());
+    std::cout << "Karatsuba squaring from " << tuned.karatsubaSquare + 1 << " limbs" << std::endl;
+
+    multiplyThresholds = saved;
+    threadPool.setThreadBudget(threadsWere);
+    karatsubaCache.setEnabled(cacheWasEnabled);
+    return tuned;
+}
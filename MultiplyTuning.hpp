@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+#include <string>
+
+constexpr const char* MULTIPLY_PROFILE_FILE = "multiplyprofile";
+constexpr int MULTIPLY_PROFILE_VERSION = 1;
+
+// Crossover points, in limbs, used by the BigHexInt multiplication dispatcher.
+// They start at the compiled-in defaults; loadMultiplyProfile() replaces them with
+// the values tuneMultiplyThresholds() measured on this machine.
+struct MultiplyThresholds {
+    int karatsuba = KARATSUBA_THRESHOLD;               // schoolbook up to and including this length
+    int toom3 = TOOM3_THRESHOLD;                       // Toom-3 from this length
+    int ntt = NTT_THRESHOLD;                           // NTT from this length, squares included
+    int karatsubaSquare = KARATSUBA_SQUARE_THRESHOLD;  // schoolbook squaring up to and including this length
+    int parallel = PARALLEL_MULTIPLY_THRESHOLD;        // Karatsuba/Toom-3 sub-products run on threadPool from this length
+
+    // Rejects values the recursions cannot terminate with
+    bool isValid() const;
+};
+
+extern MultiplyThresholds multiplyThresholds;
+
+// Reads the text profile written by saveMultiplyProfile. Returns false and keeps the
+// current thresholds if the file is missing, from another version or invalid.
+// The profile also carries the thread budget ("threads N", 1 when absent), which is
+// applied to threadPool; parallel multiplication is enabled by raising it.
+bool loadMultiplyProfile(const std::string& path = MULTIPLY_PROFILE_FILE);
+void saveMultiplyProfile(const std::string& path = MULTIPLY_PROFILE_FILE);
+
+// Times the algorithms against each other on random operands and returns the
+// crossovers found, leaving multiplyThresholds as it was. Takes a few seconds.
+// Timings are single-threaded; the parallel cutoff is carried over, not tuned.
+MultiplyThresholds tuneMultiplyThresholds();
@@ -0,0 +1,180 @@
+#include "Ntt.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Each prime is c * 2^k + 1 with k >= 23 and has 3 as a primitive root
+constexpr uint32_t PRIME_1 = 998244353;    // 119 * 2^23 + 1
+constexpr uint32_t PRIME_2 = 167772161;    //   5 * 2^25 + 1
+constexpr uint32_t PRIME_3 = 469762049;    //   7 * 2^26 + 1
+constexpr uint32_t PRIMITIVE_ROOT = 3;
+constexpr int MAX_LOG_LENGTH = 23;
+
+constexpr uint32_t powMod(uint64_t base, uint64_t exponent, uint32_t p) {
+    uint64_t result = 1;
+    base %= p;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = result * base % p;
+        }
+        base = base * base % p;
+        exponent >>= 1;
+    }
+    return (uint32_t)result;
+}
+
+constexpr uint32_t inverseMod(uint64_t value, uint32_t p) {
+    return powMod(value, p - 2, p);
+}
+
+// Garner's constants for x = r1 + p1 * t2 + p1 * p2 * t3
+constexpr uint32_t P1_INV_MOD_P2 = inverseMod(PRIME_1, PRIME_2);
+constexpr uint32_t P1P2_INV_MOD_P3 = inverseMod((uint64_t)PRIME_1 * PRIME_2 % PRIME_3, PRIME_3);
+constexpr uint32_t P1_MOD_P3 = PRIME_1 % PRIME_3;
+
+// In-place iterative Cooley-Tukey transform of length a.size(), a power of two.
+// The prime is a template argument so every % compiles to a multiply by a constant.
+template <uint32_t P>
+void transform(std::vector<uint32_t>& a, bool inverse) {
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    // roots[i] = w^i for a primitive n-th root w; stage len uses every (n / len)-th one
+    std::vector<uint32_t> roots(std::max<size_t>(n / 2, 1));
+    uint32_t w = powMod(PRIMITIVE_ROOT, (P - 1) / n, P);
+    if (inverse) {
+        w = inverseMod(w, P);
+    }
+    roots[0] = 1;
+    for (size_t i = 1; i < roots.size(); i++) {
+        roots[i] = (uint64_t)roots[i - 1] * w % P;
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len / 2;
+        size_t stride = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; j++) {
+                uint32_t u = a[i + j];
+                uint32_t v = (uint64_t)a[i + j + half] * roots[j * stride] % P;
+                uint32_t sum = u + v;
+                a[i + j] = (sum >= P) ? sum - P : sum;
+                a[i + j + half] = (u >= v) ? u - v : u + P - v;
+            }
+        }
+    }
+
+    if (inverse) {
+        uint32_t scale = inverseMod(n, P);
+        for (uint32_t& x : a) {
+            x = (uint64_t)x * scale % P;
+        }
+    }
+}
+
+// Cyclic convolution of the coefficient vectors modulo P; b == nullptr squares a
+template <uint32_t P>
+std::vector<uint32_t> convolve(const std::vector<uint32_t>& a, const std::vector<uint32_t>* b) {
+    std::vector<uint32_t> fa(a);
+    for (uint32_t& x : fa) {
+        x %= P;
+    }
+    transform<P>(fa, false);
+    if (b == nullptr) {
+        for (uint32_t& x : fa) {
+            x = (uint64_t)x * x % P;
+        }
+    } else {
+        std::vector<uint32_t> fb(*b);
+        for (uint32_t& x : fb) {
+            x %= P;
+        }
+        transform<P>(fb, false);
+        for (size_t i = 0; i < fa.size(); i++) {
+            fa[i] = (uint64_t)fa[i] * fb[i] % P;
+        }
+    }
+    transform<P>(fa, true);
+    return fa;
+}
+
+// Two 32-bit coefficients per limb, zero-padded to the transform length
+std::vector<uint32_t> toCoefficients(const Limb* limbs, int len, size_t size) {
+    std::vector<uint32_t> coefficients(size, 0);
+    for (int i = 0; i < len; i++) {
+        coefficients[2 * i] = (uint32_t)limbs[i];
+        coefficients[2 * i + 1] = (uint32_t)(limbs[i] >> 32);
+    }
+    return coefficients;
+}
+
+size_t transformLength(int aLen, int bLen) {
+    size_t n = 1;
+    while (n < (size_t)2 * (aLen + bLen)) {
+        n <<= 1;
+    }
+    return n;
+}
+
+// Rebuilds every coefficient from its three residues and carries into 32-bit halves of result
+void recombine(Limb* result, int resultLen, const std::vector<uint32_t>& r1,
+               const std::vector<uint32_t>& r2, const std::vector<uint32_t>& r3) {
+    DoubleLimb carry = 0;
+    for (int i = 0; i < 2 * resultLen; i++) {
+        uint64_t x1 = r1[i];
+        uint64_t t2 = (r2[i] + PRIME_2 - x1 % PRIME_2) % PRIME_2 * P1_INV_MOD_P2 % PRIME_2;
+        uint64_t partial = (x1 + (uint64_t)P1_MOD_P3 * t2) % PRIME_3;
+        uint64_t t3 = (r3[i] + PRIME_3 - partial) % PRIME_3 * P1P2_INV_MOD_P3 % PRIME_3;
+
+        carry += (DoubleLimb)x1 + (DoubleLimb)PRIME_1 * t2 + (DoubleLimb)PRIME_1 * PRIME_2 * t3;
+        uint32_t half = (uint32_t)carry;
+        carry >>= 32;
+        if (i & 1) {
+            result[i / 2] |= (Limb)half << 32;
+        } else {
+            result[i / 2] = half;
+        }
+    }
+}
+
+// The three primes are independent convolutions and run as thread pool tasks
+void convolveAll(Limb* result, int resultLen, const std::vector<uint32_t>& a, const std::vector<uint32_t>* b) {
+    std::vector<uint32_t> r1, r2, r3;
+    threadPool.run({
+        [&]() { r1 = convolve<PRIME_1>(a, b); },
+        [&]() { r2 = convolve<PRIME_2>(a, b); },
+        [&]() { r3 = convolve<PRIME_3>(a, b); }
+    });
+    recombine(result, resultLen, r1, r2, r3);
+}
+
+} // namespace
+
+bool nttSupports(int aLen, int bLen) {
+    return (size_t)2 * (aLen + bLen) <= ((size_t)1 << MAX_LOG_LENGTH);
+}
+
+void nttMulLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen) {
+    size_t n = transformLength(aLen, bLen);
+    std::vector<uint32_t> ca = toCoefficients(a, aLen, n);
+    std::vector<uint32_t> cb = toCoefficients(b, bLen, n);
+    convolveAll(result, aLen + bLen, ca, &cb);
+}
+
+void nttSqrLimbs(Limb* result, const Limb* a, int aLen) {
+    size_t n = transformLength(aLen, aLen);
+    std::vector<uint32_t> ca = toCoefficients(a, aLen, n);
+    convolveAll(result, 2 * aLen, ca, nullptr);
+}
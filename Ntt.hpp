@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Bigint.hpp"
+
+// Multiplication by number-theoretic transform for operands far beyond the Toom-3
+// range. Limbs are cut into 32-bit coefficients, the cyclic convolution is taken
+// modulo three NTT-friendly primes below 2^30 and the exact coefficients (below
+// 2^86) are rebuilt with the Chinese remainder theorem before carrying. The three
+// primes' convolutions run in parallel when threadPool has workers.
+
+// The transform length is bounded by the smallest prime's 2^23 roots of unity,
+// so products of up to NTT_MAX_LIMBS limbs in total are supported
+constexpr int NTT_MAX_LIMBS = 1 << 22;
+
+// Whether an aLen x bLen limb product fits in one transform
+bool nttSupports(int aLen, int bLen);
+// result[0 .. aLen+bLen) = a * b; requires nttSupports(aLen, bLen), result may alias neither input
+void nttMulLimbs(Limb* result, const Limb* a, int aLen, const Limb* b, int bLen);
+// result[0 .. 2*aLen) = a * a with one forward transform per prime instead of two
+void nttSqrLimbs(Limb* result, const Limb* a, int aLen);
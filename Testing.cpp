@@ -1,6 +1,12 @@
 #include "Testing.hpp"
 #include "Timer.hpp"
 #include "BigInt.hpp"
+#include "KaratsubaCache.hpp"
+#include "LimbKernels.hpp"
+#include "ThreadPool.hpp"
+#include "MultiplyTuning.hpp"
+#include "Montgomery.hpp"
+#include "Barrett.hpp"
 
 #include <fstream>
 #include <sstream>
@@ -8,6 +14,10 @@
 #include <string>
 #include <iostream>
 #include <utility>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <thread>
 
 void test_Bigdata_Hex(char operation)
 {
@@ -166,3 +176,745 @@ void test_Bigdata_Deci(char operation)
     }
     }
 }
+
+static BigHexInt randomBigHexInt(std::mt19937_64& rng, int limbCount)
+{
+    std::string hex;
+    const char* digits = "0123456789abcdef";
+    for (int i = 0; i < limbCount * HEX_DIGITS_PER_LIMB; i++)
+    {
+        hex += digits[rng() % 16];
+    }
+    hex[0] = '8';
+    return BigHexInt(hex);
+}
+
+// Average nanoseconds per call of a.multiply(b, algorithm)
+static double timeMultiply(const BigHexInt& a, const BigHexInt& b, MultiplyAlgorithm algorithm, int reps)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < reps; r++)
+    {
+        BigHexInt product = a.multiply(b, algorithm);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / reps;
+}
+
+void benchmark_Multiply_Crossover()
+{
+    const int sizes[] = {4, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 2048, 4096};
+    const MultiplyAlgorithm algorithms[] = {MultiplyAlgorithm::Schoolbook, MultiplyAlgorithm::Karatsuba,
+                                            MultiplyAlgorithm::Toom3, MultiplyAlgorithm::Ntt};
+    const char* names[] = {"Schoolbook", "Karatsuba", "Toom-3", "NTT"};
+    const int algorithmCount = 4;
+
+    // Repeated operands would be answered by the memo cache instead of being multiplied
+    bool cacheWasEnabled = karatsubaCache.isEnabled();
+    karatsubaCache.setEnabled(false);
+    std::mt19937_64 rng(12345);
+    int crossover[algorithmCount] = {0, 0, 0, 0};
+
+    Timer t("Multiplication crossover benchmark");
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::setw(8) << "limbs" << std::setw(9) << "bits";
+    for (int k = 0; k < algorithmCount; k++)
+    {
+        std::cout << std::setw(15) << names[k];
+    }
+    std::cout << "   (ns per multiplication)" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    for (int limbs : sizes)
+    {
+        BigHexInt a = randomBigHexInt(rng, limbs);
+        BigHexInt b = randomBigHexInt(rng, limbs);
+        int reps = std::max(5, 4000000 / (limbs * limbs));
+
+        double ns[algorithmCount];
+        int fastest = 0;
+        for (int k = 0; k < algorithmCount; k++)
+        {
+            ns[k] = timeMultiply(a, b, algorithms[k], reps);
+            if (ns[k] < ns[fastest])
+            {
+                fastest = k;
+            }
+        }
+        if (crossover[fastest] == 0)
+        {
+            crossover[fastest] = limbs;
+        }
+        std::cout << std::setw(8) << limbs << std::setw(9) << limbs * LIMB_BITS;
+        for (int k = 0; k < algorithmCount; k++)
+        {
+            std::cout << std::setw(15) << ns[k];
+        }
+        std::cout << "   fastest: " << names[fastest] << std::endl;
+    }
+    for (int k = 1; k < algorithmCount; k++)
+    {
+        if (crossover[k] != 0)
+        {
+            std::cout << names[k] << " is fastest from " << crossover[k] << " limbs ("
+                      << crossover[k] * LIMB_BITS << " bits)" << std::endl;
+        }
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    karatsubaCache.setEnabled(cacheWasEnabled);
+}
+
+void benchmark_Multiply_Scaling()
+{
+    const int hexDigits[] = {10000, 30000, 100000, 300000, 1000000, 3000000, 10000000};
+
+    bool cacheWasEnabled = karatsubaCache.isEnabled();
+    karatsubaCache.setEnabled(false);
+    std::mt19937_64 rng(12345);
+    double previousMs = 0;
+
+    Timer t("NTT scaling benchmark");
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::setw(10) << "hex digits" << std::setw(11) << "limbs" << std::setw(13) << "ms"
+              << std::setw(11) << "growth" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int digits : hexDigits)
+    {
+        int limbs = digits / HEX_DIGITS_PER_LIMB;
+        BigHexInt a = randomBigHexInt(rng, limbs);
+        BigHexInt b = randomBigHexInt(rng, limbs);
+        int reps = std::max(1, 2000000 / digits);
+
+        double ms = timeMultiply(a, b, MultiplyAlgorithm::Ntt, reps) / 1e6;
+        std::cout << std::setw(10) << digits << std::setw(11) << limbs << std::setw(13) << ms;
+        if (previousMs > 0)
+        {
+            std::cout << std::setw(10) << ms / previousMs << "x" << std::endl;
+        }
+        else
+        {
+            std::cout << std::setw(11) << "-" << std::endl;
+        }
+        previousMs = ms;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    karatsubaCache.setEnabled(cacheWasEnabled);
+}
+
+void benchmark_Limb_Kernels()
+{
+    const int sizes[] = {4, 16, 64, 256, 1024, 8192};
+    const LimbKernelSet sets[] = {LimbKernelSet::Portable, LimbKernelSet::CarryChain, LimbKernelSet::Avx2, LimbKernelSet::Avx512};
+    LimbKernelSet active = activeLimbKernels();
+    std::mt19937_64 rng(12345);
+
+    Timer t("Limb kernel benchmark");
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::setw(8) << "limbs" << std::setw(13) << "kernels" << std::setw(13) << "add" << std::setw(13) << "sub"
+              << std::setw(13) << "compare" << "   (ns per call, active: " << limbKernelSetName(active) << ")" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int limbs : sizes)
+    {
+        std::vector<Limb> a(limbs), b(limbs), result(limbs);
+        for (int i = 0; i < limbs; i++)
+        {
+            a[i] = rng();
+            b[i] = a[i] >> 1;
+        }
+        int reps = std::max(100, 20000000 / limbs);
+
+        for (LimbKernelSet set : sets)
+        {
+            if (!limbKernelsSupported(set))
+            {
+                continue;
+            }
+            selectLimbKernels(set);
+            auto time = [reps](auto&& operation) {
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int r = 0; r < reps; r++)
+                {
+                    operation();
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                return std::chrono::duration<double, std::nano>(end - start).count() / reps;
+            };
+            volatile int sink = 0;
+            double add = time([&]() { sink = sink + (int)addLimbs(result.data(), a.data(), limbs, b.data(), limbs); });
+            double sub = time([&]() { subLimbs(result.data(), a.data(), limbs, b.data(), limbs); });
+            double compare = time([&]() { sink = sink + compareLimbs(a.data(), limbs, a.data(), limbs); });
+            std::cout << std::setw(8) << limbs << std::setw(13) << limbKernelSetName(set) << std::setw(13) << add
+                      << std::setw(13) << sub << std::setw(13) << compare << std::endl;
+        }
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    selectLimbKernels(active);
+}
+
+void benchmark_Parallel_Multiply()
+{
+    const int hexDigits[] = {100000, 1000000};
+    const MultiplyAlgorithm algorithms[] = {MultiplyAlgorithm::Karatsuba, MultiplyAlgorithm::Toom3, MultiplyAlgorithm::Ntt};
+    const char* names[] = {"Karatsuba", "Toom-3", "NTT"};
+    int hardware = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<int> budgets;
+    for (int threads = 1; threads < hardware; threads *= 2)
+    {
+        budgets.push_back(threads);
+    }
+    budgets.push_back(hardware);
+
+    bool cacheWasEnabled = karatsubaCache.isEnabled();
+    karatsubaCache.setEnabled(false);
+    int threadsWere = threadPool.getThreadBudget();
+    std::mt19937_64 rng(12345);
+
+    Timer t("Parallel multiplication benchmark");
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::setw(10) << "hex digits" << std::setw(11) << "algorithm";
+    for (int threads : budgets)
+    {
+        std::cout << std::setw(8) << threads << " thr";
+    }
+    std::cout << std::setw(10) << "speedup" << "   (ms per multiplication)" << std::endl;
+    std::cout << std::fixed;
+    for (int digits : hexDigits)
+    {
+        int limbs = digits / HEX_DIGITS_PER_LIMB;
+        BigHexInt a = randomBigHexInt(rng, limbs);
+        BigHexInt b = randomBigHexInt(rng, limbs);
+        for (int k = 0; k < 3; k++)
+        {
+            std::cout << std::setw(10) << digits << std::setw(11) << names[k];
+            double serialMs = 0, bestMs = 0;
+            for (int threads : budgets)
+            {
+                threadPool.setThreadBudget(threads);
+                double ms = timeMultiply(a, b, algorithms[k], 1) / 1e6;
+                if (threads == 1)
+                {
+                    serialMs = bestMs = ms;
+                }
+                bestMs = std::min(bestMs, ms);
+                std::cout << std::setprecision(1) << std::setw(12) << ms;
+            }
+            std::cout << std::setprecision(2) << std::setw(9) << serialMs / bestMs << "x" << std::endl;
+        }
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    threadPool.setThreadBudget(threadsWere);
+    karatsubaCache.setEnabled(cacheWasEnabled);
+}
+
+// Operands for the correctness checks: random limbs, every bit set (longest carry and
+// borrow chains) and sparse values with a few scattered bits. The top limb is never
+// zero, so the value has exactly limbCount limbs and takes the path sized for that.
+enum class OperandShape { Random, AllOnes, Sparse };
+const OperandShape operandShapes[] = {OperandShape::Random, OperandShape::AllOnes, OperandShape::Sparse};
+
+static BigHexInt checkOperand(std::mt19937_64& rng, int limbCount, OperandShape shape)
+{
+    BigHexInt value;
+    value.resize(limbCount);
+    for (int i = 0; i < limbCount; i++)
+    {
+        value.limbs[i] = (shape == OperandShape::Random) ? rng() : (shape == OperandShape::AllOnes) ? ~(Limb)0 : 0;
+    }
+    if (shape == OperandShape::Sparse)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int bit = (int)(rng() % (limbCount * LIMB_BITS));
+            value.limbs[bit / LIMB_BITS] |= (Limb)1 << (bit % LIMB_BITS);
+        }
+        value.limbs[limbCount - 1] |= (Limb)1 << (rng() % LIMB_BITS);
+    }
+    if (value.limbs[limbCount - 1] == 0)
+    {
+        value.limbs[limbCount - 1] = 1;
+    }
+    return value;
+}
+
+static const char* shapeName(OperandShape shape)
+{
+    return (shape == OperandShape::Random) ? "random" : (shape == OperandShape::AllOnes) ? "all-ones" : "sparse";
+}
+
+// Counts the cases of one check and keeps the first failure for the report
+struct CheckTally
+{
+    std::string name;
+    int cases = 0;
+    int failures = 0;
+    std::string firstFailure;
+
+    explicit CheckTally(const std::string& checkName) : name(checkName) {}
+
+    void expect(bool passed, const std::string& context)
+    {
+        cases++;
+        if (!passed && failures++ == 0)
+        {
+            firstFailure = context;
+        }
+    }
+
+    bool report() const
+    {
+        std::cout << std::left << std::setw(34) << name << std::right << std::setw(7) << cases << " cases, "
+                  << failures << " failed";
+        if (failures > 0)
+        {
+            std::cout << " (first: " << firstFailure << ")";
+        }
+        std::cout << std::endl;
+        return failures == 0;
+    }
+};
+
+static std::string describeOperands(int aLimbs, int bLimbs, OperandShape shape)
+{
+    return std::to_string(aLimbs) + " x " + std::to_string(bLimbs) + " limbs, " + shapeName(shape);
+}
+
+// Every algorithm against schoolbook (multiplyNaive), and each product against the
+// division, which does not multiply: p / a == b and p % a == 0
+static bool checkMultiplication(std::mt19937_64& rng)
+{
+    const int sizes[] = {1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 24, 25, 31, 32, 33, 47, 64, 65, 96, 128, 129, 200, 256, 300, 1024};
+    const MultiplyAlgorithm algorithms[] = {MultiplyAlgorithm::Automatic, MultiplyAlgorithm::Karatsuba,
+                                            MultiplyAlgorithm::Toom3, MultiplyAlgorithm::Ntt};
+    const char* names[] = {"automatic", "Karatsuba", "Toom-3", "NTT"};
+    const int algorithmCount = 4;
+    CheckTally products("multiply vs schoolbook");
+    CheckTally squares("square vs schoolbook");
+    CheckTally quotients("product / operand");
+    for (int limbs : sizes)
+    {
+        for (OperandShape shape : operandShapes)
+        {
+            // Balanced, then unbalanced pairs that take the chunked path
+            for (int bLimbs : {limbs, std::max(1, limbs / 3), limbs * 3 + 1})
+            {
+                BigHexInt a = checkOperand(rng, limbs, shape);
+                BigHexInt b = checkOperand(rng, bLimbs, shape);
+                BigHexInt expected = a.multiply(b, MultiplyAlgorithm::Schoolbook);
+                for (int k = 0; k < algorithmCount; k++)
+                {
+                    products.expect(a.multiply(b, algorithms[k]).compare(expected) == 0,
+                                    std::string(names[k]) + ", " + describeOperands(limbs, bLimbs, shape));
+                }
+                quotients.expect((expected / a).compare(b) == 0 && (expected % a).isZero(),
+                                 describeOperands(limbs, bLimbs, shape));
+            }
+            BigHexInt a = checkOperand(rng, limbs, shape);
+            squares.expect(a.square().compare(a.multiply(a, MultiplyAlgorithm::Schoolbook)) == 0,
+                           describeOperands(limbs, limbs, shape));
+        }
+    }
+    bool passed = products.report();
+    passed = squares.report() && passed;
+    return quotients.report() && passed;
+}
+
+static BigHexInt magnitude(BigHexInt value)
+{
+    value.isNegative = false;
+    return value;
+}
+
+// a == q * b + r with |r| < |b| and r zero or of a's sign (truncating division)
+static bool isDivision(const BigHexInt& a, const BigHexInt& b, const BigHexInt& q, const BigHexInt& r)
+{
+    bool signOk = r.isZero() || r.isNegative == a.isNegative;
+    return (q * b + r).compare(a) == 0 && magnitude(r).compare(magnitude(b)) < 0 && signOk;
+}
+
+// Knuth's Algorithm D against the identity it must satisfy, for every sign combination.
+// The fixed cases are the 64-bit forms of Hacker's Delight's divmnu tests, which need the
+// rare add-back step after an overestimated quotient limb.
+static bool checkDivision(std::mt19937_64& rng)
+{
+    const int sizes[] = {1, 2, 3, 4, 5, 8, 16, 17, 33, 64, 65, 128, 200};
+    const std::pair<const char*, const char*> addBackCases[] = {
+        {"7fffffffffffffff800000000000000000000000000000000000000000000000", "800000000000000000000000000000000000000000000001"},
+        {"80000000000000000000000000000000fffffffffffffffe0000000000000000", "80000000000000000000000000000000ffffffffffffffff"},
+        {"800000000000000000000000000000000000000000000003", "200000000000000000000000000000000000000000000001"},
+    };
+    CheckTally division("divide and remainder");
+    auto check = [&division](BigHexInt a, BigHexInt b, const std::string& context)
+    {
+        for (int signs = 0; signs < 4; signs++)
+        {
+            a.isNegative = (signs & 1) != 0 && !a.isZero();
+            b.isNegative = (signs & 2) != 0;
+            division.expect(isDivision(a, b, a / b, a % b), context);
+        }
+    };
+    for (const auto& fixed : addBackCases)
+    {
+        check(BigHexInt(fixed.first), BigHexInt(fixed.second), std::string("add-back case ") + fixed.first);
+    }
+    for (int aLimbs : sizes)
+    {
+        for (int bLimbs : sizes)
+        {
+            if (bLimbs > aLimbs + 1)
+            {
+                continue;
+            }
+            for (OperandShape shape : operandShapes)
+            {
+                // The dividend's shape is varied too: random over a structured divisor
+                // and the reverse give the quotient estimate different edge cases
+                check(checkOperand(rng, aLimbs, shape), checkOperand(rng, bLimbs, shape), describeOperands(aLimbs, bLimbs, shape));
+                check(checkOperand(rng, aLimbs, OperandShape::Random), checkOperand(rng, bLimbs, shape),
+                      "random / " + describeOperands(aLimbs, bLimbs, shape));
+                check(checkOperand(rng, aLimbs, shape), checkOperand(rng, bLimbs, OperandShape::Random),
+                      describeOperands(aLimbs, bLimbs, shape) + " / random");
+            }
+        }
+    }
+    return division.report();
+}
+
+// Moduli on both sides of MONTGOMERY_SHORT_PRODUCT_THRESHOLD, so the interleaved loop and
+// the short product reduction (reduceShort) are both covered
+const int modulusSizes[] = {1, 2, 3, 8, 16, 17, 32, 48, 49, 64, 65, 100};
+
+// Exponents of a few limbs keep the division-based reference fast on large moduli
+static BigHexInt checkExponent(std::mt19937_64& rng, int modulusLimbs, OperandShape shape)
+{
+    return checkOperand(rng, std::min(modulusLimbs, 3), shape);
+}
+
+// Montgomery products and powers against plain multiplication and %
+static bool checkMontgomery(std::mt19937_64& rng)
+{
+    CheckTally products("Montgomery multiply");
+    CheckTally powers("Montgomery modPow");
+    for (int limbs : modulusSizes)
+    {
+        for (OperandShape shape : operandShapes)
+        {
+            BigHexInt modulus = checkOperand(rng, limbs, shape);
+            modulus.limbs[0] |= 1;
+            if (modulus.isOne())
+            {
+                continue;
+            }
+            MontgomeryContext context(modulus);
+            std::string described = std::to_string(limbs) + " limb " + shapeName(shape) + " modulus";
+            for (OperandShape operandShape : operandShapes)
+            {
+                BigHexInt a = checkOperand(rng, limbs + 1, operandShape);
+                BigHexInt b = checkOperand(rng, limbs, operandShape);
+                BigHexInt product = context.fromMontgomery(context.multiply(context.toMontgomery(a), context.toMontgomery(b)));
+                products.expect(product.compare((a * b) % modulus) == 0, described);
+
+                BigHexInt exponent = checkExponent(rng, limbs, operandShape);
+                BigHexInt expected = a.modPow(exponent, modulus, ModularReducer::Division);
+                powers.expect(a.modPow(exponent, modulus, ModularReducer::Montgomery).compare(expected) == 0 &&
+                              a.modPow(exponent, context).compare(expected) == 0,
+                              described + ", " + shapeName(operandShape) + " operands");
+            }
+        }
+    }
+    bool passed = products.report();
+    return powers.report() && passed;
+}
+
+// Barrett reduction, products and powers against plain % for even and odd moduli.
+// Values up to the double width reduceWide handles and beyond it, of either sign.
+static bool checkBarrett(std::mt19937_64& rng)
+{
+    CheckTally reductions("Barrett reduce");
+    CheckTally powers("Barrett multiply and modPow");
+    for (int limbs : modulusSizes)
+    {
+        for (OperandShape shape : operandShapes)
+        {
+            BigHexInt modulus = checkOperand(rng, limbs, shape);
+            BarrettContext context(modulus);
+            std::string described = std::to_string(limbs) + " limb " + shapeName(shape) + " modulus";
+            for (OperandShape valueShape : operandShapes)
+            {
+                for (int valueLimbs : {1, limbs, 2 * limbs, 2 * limbs + 1, 3 * limbs})
+                {
+                    BigHexInt value = checkOperand(rng, valueLimbs, valueShape);
+                    for (bool negative : {false, true})
+                    {
+                        value.isNegative = negative;
+                        BigHexInt expected = value % modulus;
+                        if (expected.isNegative && !expected.isZero())
+                        {
+                            expected = expected + modulus;
+                        }
+                        reductions.expect(context.reduce(value).compare(expected) == 0,
+                                          described + ", " + std::to_string(valueLimbs) + " limb " + shapeName(valueShape) + " value");
+                    }
+                }
+
+                BigHexInt a = checkOperand(rng, limbs, valueShape);
+                BigHexInt b = checkOperand(rng, limbs + 1, valueShape);
+                BigHexInt exponent = checkExponent(rng, limbs, valueShape);
+                BigHexInt expected = a.modPow(exponent, modulus, ModularReducer::Division);
+                powers.expect(context.multiply(a, b).compare((a * b) % modulus) == 0 &&
+                              a.modPow(exponent, modulus, ModularReducer::Barrett).compare(expected) == 0 &&
+                              a.modPow(exponent, context).compare(expected) == 0,
+                              described + ", " + shapeName(valueShape) + " operands");
+            }
+        }
+    }
+    bool passed = reductions.report();
+    return powers.report() && passed;
+}
+
+// Fixed-base powers against the division reducer, with exponents inside the table and
+// longer ones that take the sliding window fallback
+static bool checkFixedBase(std::mt19937_64& rng)
+{
+    CheckTally powers("FixedBaseContext pow");
+    for (int limbs : {1, 2, 8, 17, 49})
+    {
+        for (OperandShape shape : operandShapes)
+        {
+            BigHexInt modulus = checkOperand(rng, limbs, shape);
+            modulus.limbs[0] |= 1;
+            if (modulus.isOne())
+            {
+                continue;
+            }
+            BigHexInt base = checkOperand(rng, limbs, OperandShape::Random);
+            for (int tableBits : {0, 64})
+            {
+                FixedBaseContext context(base, modulus, tableBits);
+                for (OperandShape exponentShape : operandShapes)
+                {
+                    for (int exponentLimbs : {1, std::min(limbs, 3), std::min(limbs, 3) + 1})
+                    {
+                        BigHexInt exponent = checkOperand(rng, exponentLimbs, exponentShape);
+                        powers.expect(context.pow(exponent).compare(base.modPow(exponent, modulus, ModularReducer::Division)) == 0,
+                                      std::to_string(limbs) + " limb " + shapeName(shape) + " modulus, table for " +
+                                      std::to_string(tableBits) + " bits, " + std::to_string(exponentLimbs) + " limb " +
+                                      shapeName(exponentShape) + " exponent");
+                    }
+                }
+            }
+        }
+    }
+    return powers.report();
+}
+
+// Every instruction set the CPU supports against the portable kernels. Lengths cover the
+// vector widths and their remainders, with both operands equally long and the second shorter.
+static bool checkLimbKernels(std::mt19937_64& rng)
+{
+    const LimbKernelSet sets[] = {LimbKernelSet::CarryChain, LimbKernelSet::Avx2, LimbKernelSet::Avx512};
+    LimbKernelSet active = activeLimbKernels();
+    CheckTally kernels("limb kernels vs portable");
+
+    // Results of add, sub and three compares under the selected set, in one vector
+    auto run = [](const BigHexInt& a, const BigHexInt& b)
+    {
+        std::vector<Limb> out(2 * a.length + 4);
+        out[a.length] = addLimbs(out.data(), a.limbs, a.length, b.limbs, b.length);
+        subLimbs(out.data() + a.length + 1, a.limbs, a.length, b.limbs, b.length);
+        out[2 * a.length + 1] = (Limb)compareLimbs(a.limbs, a.length, b.limbs, b.length);
+        out[2 * a.length + 2] = (Limb)compareLimbs(b.limbs, b.length, a.limbs, a.length);
+        out[2 * a.length + 3] = (Limb)compareLimbs(a.limbs, a.length, a.limbs, a.length);
+        return out;
+    };
+    const int sizes[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 15, 16, 17, 23, 24, 25, 31, 32, 33, 64, 100, 257};
+    for (int limbs : sizes)
+    {
+        for (OperandShape shape : operandShapes)
+        {
+            for (int bLimbs : {limbs, std::max(1, limbs - 1), std::max(1, limbs / 2), 1})
+            {
+                BigHexInt a = checkOperand(rng, limbs, shape);
+                BigHexInt b = checkOperand(rng, bLimbs, shape);
+                if (bLimbs == 1)
+                {
+                    // All-ones plus one carries through every lane
+                    b.limbs[0] = 1;
+                }
+                if (a.compare(b) < 0)
+                {
+                    std::swap(a, b);
+                }
+                if (b.length > a.length)
+                {
+                    continue;
+                }
+                selectLimbKernels(LimbKernelSet::Portable);
+                std::vector<Limb> expected = run(a, b);
+                for (LimbKernelSet set : sets)
+                {
+                    if (!limbKernelsSupported(set))
+                    {
+                        continue;
+                    }
+                    selectLimbKernels(set);
+                    kernels.expect(run(a, b) == expected,
+                                   std::string(limbKernelSetName(set)) + ", " + describeOperands(limbs, bLimbs, shape));
+                }
+            }
+        }
+    }
+    selectLimbKernels(active);
+    return kernels.report();
+}
+
+// mulLow must equal the full product mod B^n. mulHigh may fall short of floor(a * b / B^n)
+// by at most 1 at schoolbook sizes and by less than n above them (see mulHighLimbs).
+static bool checkShortProducts(std::mt19937_64& rng)
+{
+    const int sizes[] = {1, 2, 3, 5, 8, 16, 24, 25, 32, 33, 64, 100, 128, 200};
+    CheckTally low("mulLow exact");
+    CheckTally high("mulHigh error bound");
+    for (int n : sizes)
+    {
+        BigHexInt radix = BigHexInt("1") << (n * LIMB_BITS);
+        int allowedError = (n <= multiplyThresholds.karatsuba) ? 1 : n - 1;
+        for (OperandShape shape : operandShapes)
+        {
+            for (int bLimbs : {n, std::max(1, n / 2)})
+            {
+                BigHexInt a = checkOperand(rng, n, shape);
+                BigHexInt b = checkOperand(rng, bLimbs, shape);
+                BigHexInt full = a.multiply(b, MultiplyAlgorithm::Schoolbook);
+                std::string described = std::to_string(n) + " limbs, " + describeOperands(n, bLimbs, shape);
+                low.expect(a.mulLow(b, n).compare(full % radix) == 0, described);
+
+                BigHexInt error = full / radix - a.mulHigh(b, n);
+                high.expect(!error.isNegative && error.compare(BigHexInt(std::to_string(allowedError))) <= 0, described);
+            }
+            // Longer operands are reduced mod B^n first
+            BigHexInt a = checkOperand(rng, 2 * n + 1, shape);
+            BigHexInt b = checkOperand(rng, n + 1, shape);
+            low.expect(a.mulLow(b, n).compare((a * b) % radix) == 0, describeOperands(2 * n + 1, n + 1, shape) + " mod B^" + std::to_string(n));
+        }
+    }
+    bool passed = low.report();
+    return high.report() && passed;
+}
+
+// Two's complement semantics pinned down by a & (2^k - 1) == a mod 2^k (rounded down) and
+// the identities that hold for every sign; shifts against multiplication and division
+// by 2^k; the bit queries against each other on the magnitude
+static bool checkBitwise(std::mt19937_64& rng)
+{
+    const int sizes[] = {1, 2, 3, 5, 8, 17, 40};
+    BigHexInt one("1");
+    CheckTally operators("bitwise & | ^ ~");
+    CheckTally shifts("bit shifts");
+    CheckTally queries("bitLength testBit popcount");
+    for (int aLimbs : sizes)
+    {
+        for (int bLimbs : {1, aLimbs, aLimbs + 2})
+        {
+            for (OperandShape shape : operandShapes)
+            {
+                BigHexInt a = checkOperand(rng, aLimbs, shape);
+                BigHexInt b = checkOperand(rng, bLimbs, OperandShape::Random);
+                for (int signs = 0; signs < 4; signs++)
+                {
+                    a.isNegative = (signs & 1) != 0;
+                    b.isNegative = (signs & 2) != 0;
+                    std::string described = std::string(a.isNegative ? "-" : "+") + (b.isNegative ? "-" : "+") + " " +
+                                            describeOperands(aLimbs, bLimbs, shape);
+                    int maskBits = (int)(rng() % ((aLimbs + 1) * LIMB_BITS)) + 1;
+                    BigHexInt radix = one << maskBits;
+                    BigHexInt residue = a % radix;
+                    if (residue.isNegative && !residue.isZero())
+                    {
+                        residue = residue + radix;
+                    }
+                    BigHexInt both = a & b, either = a | b, differ = a ^ b;
+                    operators.expect((a & (radix - one)).compare(residue) == 0 &&
+                                     (a + b).compare(differ + (both << 1)) == 0 &&
+                                     either.compare(differ + both) == 0 &&
+                                     (~a).compare(BigHexInt("0") - a - one) == 0 &&
+                                     (~both).compare(~a | ~b) == 0 &&
+                                     (a ^ a).isZero() && (a & ~a).isZero() && (a | ~a).compare(BigHexInt("-1")) == 0,
+                                     described + ", mask of " + std::to_string(maskBits) + " bits");
+
+                    int k = (int)(rng() % (3 * LIMB_BITS));
+                    BigHexInt power = one << k;
+                    shifts.expect((a << k).compare(a * power) == 0 && (a >> k).compare(a / power) == 0,
+                                  described + ", shift by " + std::to_string(k));
+                }
+
+                BigHexInt value = magnitude(a);
+                int bits = value.bitLength();
+                int count = 0;
+                bool bitsMatch = !value.testBit(-1) && !value.testBit(bits) && !value.testBit(bits + 1000);
+                for (int i = 0; i < bits; i++)
+                {
+                    bool bit = value.testBit(i);
+                    count += bit;
+                    bitsMatch = bitsMatch && (bit == !((value >> i) % BigHexInt("2")).isZero());
+                }
+                queries.expect(bitsMatch && count == value.popcount() && value.testBit(bits - 1) &&
+                               (value >> bits).isZero() && a.bitLength() == bits,
+                               describeOperands(aLimbs, aLimbs, shape));
+            }
+        }
+    }
+    bool passed = operators.report();
+    passed = shifts.report() && passed;
+    return queries.report() && passed;
+}
+
+static bool runChecks(std::mt19937_64& rng)
+{
+    bool passed = checkMultiplication(rng);
+    passed = checkDivision(rng) && passed;
+    passed = checkMontgomery(rng) && passed;
+    passed = checkBarrett(rng) && passed;
+    passed = checkFixedBase(rng) && passed;
+    passed = checkLimbKernels(rng) && passed;
+    passed = checkShortProducts(rng) && passed;
+    passed = checkBitwise(rng) && passed;
+    return passed;
+}
+
+bool check_Arithmetic()
+{
+    // Memoized products would be answered from the cache instead of being recomputed
+    bool cacheWasEnabled = karatsubaCache.isEnabled();
+    karatsubaCache.setEnabled(false);
+    MultiplyThresholds saved = multiplyThresholds;
+    std::mt19937_64 rng(12345);
+
+    // Once as configured, once with the smallest thresholds the recursions accept, so that
+    // operands of a few dozen limbs already go through every level and crossover
+    MultiplyThresholds smallest = saved;
+    smallest.karatsuba = 4;
+    smallest.karatsubaSquare = 4;
+    smallest.toom3 = 6;
+    smallest.ntt = 40;
+    Timer t("Arithmetic checks");
+    std::cout << "With the active multiplication thresholds:" << std::endl;
+    bool passed = runChecks(rng);
+    std::cout << "With the smallest multiplication thresholds:" << std::endl;
+    multiplyThresholds = smallest;
+    passed = runChecks(rng) && passed;
+    multiplyThresholds = saved;
+    std::cout << (passed ? "All checks passed" : "SOME CHECKS FAILED") << std::endl;
+
+    karatsubaCache.setEnabled(cacheWasEnabled);
+    return passed;
+}
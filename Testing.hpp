@@ -2,4 +2,15 @@
 
 // Single entry point to run big hex data tests
 void test_Bigdata_Hex(char operation);
-void test_Bigdata_Deci(char operation);
\ No newline at end of file
+void test_Bigdata_Deci(char operation);
+// Times every multiplication algorithm across operand sizes and reports the crossovers
+void benchmark_Multiply_Crossover();
+// Times NTT multiplication from 10^4 to 10^7 hex digits
+void benchmark_Multiply_Scaling();
+// Times the add/sub/compare limb kernels of every instruction set this CPU supports
+void benchmark_Limb_Kernels();
+// Times 10^5 and 10^6 hex digit products with growing thread budgets
+void benchmark_Parallel_Multiply();
+// Cross-checks the multiplication, division and reduction paths on random, all-ones and
+// sparse operands. Prints one line per check and returns whether all of them passed.
+bool check_Arithmetic();
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool threadPool;
+
+namespace {
+thread_local bool runningTask = false;
+}
+
+ThreadPool::ThreadPool() : stopping(false) {}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::setThreadBudget(int threads) {
+    if (threads <= 0) {
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    stopWorkers();
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+int ThreadPool::getThreadBudget() const {
+    return (int)workers.size() + 1;
+}
+
+bool ThreadPool::isParallel() const {
+    return !workers.empty();
+}
+
+bool ThreadPool::inTask() {
+    return runningTask;
+}
+
+void ThreadPool::run(const std::vector<std::function<void()>>& tasks) {
+    if (workers.empty() || tasks.size() < 2) {
+        for (const std::function<void()>& task : tasks) {
+            task();
+        }
+        return;
+    }
+
+    Group group{(int)tasks.size(), nullptr};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 1; i < tasks.size(); i++) {
+            queue.push_back(Job{&tasks[i], &group});
+        }
+    }
+    changed.notify_all();
+    execute(Job{&tasks[0], &group});
+
+    // Help instead of blocking. The newest job is most likely one of ours or a
+    // sub-task of one, so it is taken from the back while the workers take the front.
+    std::unique_lock<std::mutex> lock(mutex);
+    while (group.remaining > 0) {
+        if (!queue.empty()) {
+            Job job = queue.back();
+            queue.pop_back();
+            lock.unlock();
+            execute(job);
+            lock.lock();
+        } else {
+            changed.wait(lock);
+        }
+    }
+    if (group.error) {
+        std::rethrow_exception(group.error);
+    }
+}
+
+// Every task runs to completion even if another one threw, because the others still
+// reference the caller's stack until its run() returns
+void ThreadPool::execute(const Job& job) {
+    bool wasRunningTask = runningTask;
+    runningTask = true;
+    std::exception_ptr error;
+    try {
+        (*job.task)();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    runningTask = wasRunningTask;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error && !job.group->error) {
+            job.group->error = error;
+        }
+        job.group->remaining--;
+    }
+    changed.notify_all();
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        Job job = queue.front();
+        queue.pop_front();
+        lock.unlock();
+        execute(job);
+        lock.lock();
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    stopping = false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads shared by the parallel multiplication paths: the three sub-products of
+// a Karatsuba step, the five pointwise products of Toom-3 and the three NTT primes.
+// Parallelism is opt-in. With the default budget of one thread there are no workers and
+// every task runs on the caller, in order, exactly as the serial code did.
+class ThreadPool {
+public:
+    ThreadPool();
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total number of threads a multiplication may use, the calling thread included.
+    // Starts threads - 1 workers; 0 means one per hardware thread. Must not be called
+    // while a run() is in progress.
+    void setThreadBudget(int threads);
+    int getThreadBudget() const;
+    bool isParallel() const;
+
+    // Runs the tasks and returns once all of them have finished, then rethrows the first
+    // exception any of them threw. The caller runs the first task itself and helps with
+    // queued tasks while it waits, so run() may be called from inside a task.
+    void run(const std::vector<std::function<void()>>& tasks);
+
+    // Whether this thread is executing a task of a parallel run(). The memo cache and
+    // journal are not thread-safe, so multiplications skip them there.
+    static bool inTask();
+
+private:
+    struct Group {
+        int remaining;
+        std::exception_ptr error;
+    };
+    struct Job {
+        const std::function<void()>* task;
+        Group* group;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<Job> queue;
+    std::mutex mutex;
+    std::condition_variable changed;   // a job was queued or finished, or the workers must stop
+    bool stopping;
+
+    void workerLoop();
+    void execute(const Job& job);
+    void stopWorkers();
+};
+
+// Global pool used by BigHexInt multiplication
+extern ThreadPool threadPool;
@@ -1,7 +1,7 @@
 @echo off
 echo Compiling...
 
-g++ -std=c++17 -Wall -O2 BigInt.cpp Timer.cpp Testing.cpp exceptions.cpp main.cpp -o my_program.exe
+g++ -std=c++17 -Wall -O2 BigInt.cpp Timer.cpp Testing.cpp exceptions.cpp KaratsubaCache.cpp MemoStore.cpp Montgomery.cpp Barrett.cpp LimbKernels.cpp LimbKernelsX86.cpp Exponentiation.cpp Ntt.cpp MultiplyTuning.cpp ThreadPool.cpp main.cpp -o my_program.exe
 
 if %ERRORLEVEL% NEQ 0 (
     echo Compilation failed.
@@ -3,11 +3,13 @@
 #include "exceptions.hpp"
 #include "Timer.hpp"
 #include "Testing.hpp"
+#include "MultiplyTuning.hpp"
 
 int main() {
     try {
         std::atexit(closeAndUpdateFile);
         initializeLookupTable();
+        loadMultiplyProfile();
         bool testmode=false;
         bool isHex=true;
         char hexchar;
@@ -22,7 +24,17 @@ int main() {
             std::cin>>hexchar;
             isHex = ( hexchar== 'Y' || hexchar == 'y');
             std::cin >> op;
-            if(isHex)test_Bigdata_Hex(op);
+            if(isHex && op=='x')benchmark_Multiply_Crossover();
+            else if(isHex && op=='t'){
+                multiplyThresholds = tuneMultiplyThresholds();
+                saveMultiplyProfile();
+                std::cout<<"Multiplication profile written to "<<MULTIPLY_PROFILE_FILE<<std::endl;
+            }
+            else if(isHex && op=='n')benchmark_Multiply_Scaling();
+            else if(isHex && op=='k')benchmark_Limb_Kernels();
+            else if(isHex && op=='p')benchmark_Parallel_Multiply();
+            else if(isHex && op=='c')return check_Arithmetic() ? 0 : 1;
+            else if(isHex)test_Bigdata_Hex(op);
             else test_Bigdata_Deci(op);
             return 0;
         }